@@ -5,12 +5,14 @@
 MyActionInitialization::MyActionInitialization(
     const std::string& dataset,
     const std::string& species,
-    int iteration
+    int iteration,
+    unsigned seed
 )
 : G4VUserActionInitialization()
 , m_dataset(dataset)
 , m_species(species)
 , m_iteration(iteration)
+, m_seed(seed)
 {}
 
 void MyActionInitialization::Build() const
@@ -20,7 +22,8 @@ void MyActionInitialization::Build() const
     SetUserAction(new MyPrimaryGenerator(
         m_dataset,
         m_species,
-        m_iteration
+        m_iteration,
+        m_seed
     ));
     // Register run action
     std::cout << "[ActionInit] Enregistrement du RunAction\n";
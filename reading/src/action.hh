@@ -12,10 +12,12 @@ public:
      * @param dataset    Chemin vers le dossier OpenPMD (ex: "../3D_dataset")
      * @param species    Nom de l’espèce dans OpenPMD (ex: "electrons")
      * @param iteration  Numéro d’itération à lire (ex: 100)
+     * @param seed       Graine du tirage des primaires (0 = aléatoire)
      */
     MyActionInitialization(const std::string& dataset,
                            const std::string& species,
-                           int iteration);
+                           int iteration,
+                           unsigned seed = 0);
     ~MyActionInitialization() override = default;
 
     /** Enregistre les actionnaires : primary, run, (event) */
@@ -25,6 +27,7 @@ private:
     std::string     m_dataset;
     std::string     m_species;
     int             m_iteration;
+    unsigned        m_seed;
 };
 
 #endif // ACTION_HH
@@ -18,6 +18,10 @@ public:
     /** Branche les coques en tant que détecteurs sensibles */
     void ConstructSDandField() override;
 
+    /** Rayons et épaisseur des coques (lecture directe) */
+    const std::vector<double>& GetRadii() const { return m_radii; }
+    double GetShellThickness() const { return m_shellThickness; }
+
 private:
     std::vector<double>           m_radii;           // rayons des coques
     double                        m_shellThickness;  // épaisseur des coques
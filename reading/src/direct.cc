@@ -0,0 +1,107 @@
+// src/direct.cc
+#include "direct.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace wxg4
+{
+
+static constexpr double MEV_C_CONVERSION = 5.3442859e-22; // kg·m/s par MeV/c
+
+std::vector<std::uint32_t> draw_indices(const ParticleData& pdata,
+                                        std::size_t n,
+                                        std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<std::uint32_t> picks(n);
+    const double total = pdata.ws.back();
+    for (std::size_t k = 0; k < n; ++k) {
+        const double target = dist(gen) * total;
+        auto it = std::lower_bound(pdata.ws.begin(), pdata.ws.end(), target);
+        picks[k] = static_cast<std::uint32_t>(std::distance(pdata.ws.begin(), it));
+    }
+    return picks;
+}
+
+void direct_readout(const ParticleData& pdata,
+                    const std::vector<std::uint32_t>& picks,
+                    const std::array<double, 3>& origin,
+                    const std::vector<double>& radii,
+                    double shellThickness,
+                    DirectHits& out)
+{
+    constexpr std::size_t BLOCK = 4096;
+    constexpr double INF = std::numeric_limits<double>::infinity();
+
+    // Surfaces des coques : rayon² et coque associée
+    std::vector<double> surf2;
+    std::vector<std::uint8_t> surfShell;
+    for (std::size_t s = 0; s < radii.size(); ++s) {
+        for (double r : {radii[s] - 0.5*shellThickness, radii[s] + 0.5*shellThickness}) {
+            surf2.push_back(r*r);
+            surfShell.push_back(static_cast<std::uint8_t>(s));
+        }
+    }
+    const double ox = origin[0], oy = origin[1], oz = origin[2];
+    const double c0 = ox*ox + oy*oy + oz*oz;
+
+    std::vector<double> qx(BLOCK), qy(BLOCK), qz(BLOCK);
+    std::vector<double> b(BLOCK), tbest(BLOCK);
+    std::vector<std::uint8_t> sbest(BLOCK);
+
+    out.event.reserve(out.event.size() + picks.size());
+    out.shell.reserve(out.shell.size() + picks.size());
+    out.px.reserve(out.px.size() + picks.size());
+    out.py.reserve(out.py.size() + picks.size());
+    out.pz.reserve(out.pz.size() + picks.size());
+
+    for (std::size_t start = 0; start < picks.size(); start += BLOCK) {
+        const std::size_t n = std::min(BLOCK, picks.size() - start);
+
+        // 1) Rassemblement des impulsions tirées, en MeV/c
+        for (std::size_t k = 0; k < n; ++k) {
+            const std::uint32_t i = picks[start + k];
+            qx[k] = pdata.px[i] / MEV_C_CONVERSION;
+            qy[k] = pdata.py[i] / MEV_C_CONVERSION;
+            qz[k] = pdata.pz[i] / MEV_C_CONVERSION;
+        }
+
+        // 2) Direction unitaire et o·d
+        for (std::size_t k = 0; k < n; ++k) {
+            const double p = std::sqrt(qx[k]*qx[k] + qy[k]*qy[k] + qz[k]*qz[k]);
+            const double inv = (p > 0.0) ? 1.0 / p : 0.0;
+            b[k] = (ox*qx[k] + oy*qy[k] + oz*qz[k]) * inv;
+            tbest[k] = (p > 0.0) ? INF : -1.0;
+            sbest[k] = 0;
+        }
+
+        // 3) Première surface traversée : |o + t·d|² = r², plus petite racine t > 0
+        for (std::size_t s = 0; s < surf2.size(); ++s) {
+            const double c = c0 - surf2[s];
+            for (std::size_t k = 0; k < n; ++k) {
+                const double disc = b[k]*b[k] - c;
+                const double sq = std::sqrt(std::max(disc, 0.0));
+                const double t1 = -b[k] - sq;
+                const double t2 = -b[k] + sq;
+                const double t  = (t1 > 0.0) ? t1 : t2;
+                const bool better = disc >= 0.0 && t > 0.0 && t < tbest[k];
+                tbest[k] = better ? t : tbest[k];
+                sbest[k] = better ? surfShell[s] : sbest[k];
+            }
+        }
+
+        // 4) Hits
+        for (std::size_t k = 0; k < n; ++k) {
+            if (!(tbest[k] > 0.0) || tbest[k] == INF) continue;
+            out.event.push_back(static_cast<std::uint32_t>(start + k));
+            out.shell.push_back(sbest[k]);
+            out.px.push_back(qx[k]);
+            out.py.push_back(qy[k]);
+            out.pz.push_back(qz[k]);
+        }
+    }
+}
+
+} // namespace wxg4
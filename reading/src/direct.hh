@@ -0,0 +1,48 @@
+// src/direct.hh
+#ifndef DIRECT_HH
+#define DIRECT_HH
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "read.hh"
+
+namespace wxg4
+{
+
+/**
+ * Tire n indices exactement comme MyPrimaryGenerator::GeneratePrimaries
+ * (mt19937 + uniforme [0,1) + recherche dans ws) : avec la même graine,
+ * l'événement k du transport et l'entrée k coïncident.
+ */
+std::vector<std::uint32_t> draw_indices(const ParticleData& pdata,
+                                        std::size_t n,
+                                        std::mt19937& gen);
+
+/// Hits "analytiques" : un par primaire qui atteint une coque
+struct DirectHits {
+    std::vector<std::uint32_t> event;     // numéro d'événement (rang du tirage)
+    std::vector<std::uint8_t>  shell;     // coque touchée en premier
+    std::vector<double>        px, py, pz; // impulsion au passage [MeV/c]
+};
+
+/**
+ * Lecture directe des coques : le monde et les coques sont du vide, les
+ * primaires vont donc en ligne droite depuis `origin` et gardent leur
+ * impulsion. Pour chaque tirage on cherche la première surface de coque
+ * traversée (rayons intérieur et extérieur, mêmes unités que origin) et
+ * on enregistre l'impulsion, comme le ferait MySensitiveDetector.
+ * Traitement par blocs de tableaux contigus, vectorisable.
+ */
+void direct_readout(const ParticleData& pdata,
+                    const std::vector<std::uint32_t>& picks,
+                    const std::array<double, 3>& origin,
+                    const std::vector<double>& radii,
+                    double shellThickness,
+                    DirectHits& out);
+
+} // namespace wxg4
+
+#endif // DIRECT_HH
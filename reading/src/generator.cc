@@ -14,8 +14,9 @@
 
 MyPrimaryGenerator::MyPrimaryGenerator(const std::string& dataset,
                                        const std::string& species,
-                                       int iteration)
-: fGen{std::random_device{}()}
+                                       int iteration,
+                                       unsigned seed)
+: fGen{seed ? seed : std::random_device{}()}
 {    
     std::cout << "[Generator] Chargement des données OpenPMD : "
               << dataset << ", espèce=" << species
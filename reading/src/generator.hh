@@ -19,14 +19,19 @@ public:
      * @param dataset   Chemin vers le dossier OpenPMD (ex: "../3D_dataset")
      * @param species   Nom de l’espèce dans OpenPMD (ex: "electrons")
      * @param iteration Numéro d’itération à lire (ex: 100)
+     * @param seed      Graine du tirage (0 = aléatoire)
      */
     MyPrimaryGenerator(const std::string& dataset,
                        const std::string& species,
-                       int iteration);
+                       int iteration,
+                       unsigned seed = 0);
     ~MyPrimaryGenerator() override;
 
     void GeneratePrimaries(G4Event* anEvent) override;
 
+    /// Particules filtrées (utilisées aussi par la lecture directe)
+    const wxg4::ParticleData& GetParticleData() const { return fPData; }
+
 private:
     G4ParticleGun*                         fParticleGun{nullptr};
     wxg4::ParticleData                     fPData;      // px,py,pz et ws
@@ -1,10 +1,22 @@
 #include "G4RunManager.hh"
 #include "FTFP_BERT.hh"            // physique standard simplifiée
 
+#include "G4AnalysisManager.hh"
+#include "G4RootAnalysisReader.hh"
+#include "G4SystemOfUnits.hh"
+
 #include "construction.hh"         // monde + coques sphériques
 #include "action.hh"               // PrimaryGenerator + RunAction
+#include "generator.hh"
+#include "run.hh"
+#include "direct.hh"               // lecture directe des coques
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <map>
+#include <random>
+#include <string>
 
 #include <openPMD/openPMD.hpp>
 #include <cmath>    // pour std::ceil
@@ -13,12 +25,26 @@ int main(int argc, char** argv)
 {
     if (argc < 4) {
         G4cerr << "openPMD_path, species and iteration must be specified" << G4endl;
+        G4cerr << "Usage: " << argv[0]
+               << " <openPMD_path> <species> <iteration> [transport|direct|validate] [seed]\n"
+               << "  transport : transport Geant4 complet (défaut)\n"
+               << "  direct    : intersection analytique avec les coques, sans transport\n"
+               << "  validate  : transport, puis comparaison événement par événement\n"
+               << "              avec la lecture directe (même graine)" << G4endl;
         return 1;
     }
 
     std::string openPMD_path = argv[1];
     std::string species = argv[2];
     int iteration = std::stoi(argv[3]);
+    const std::string mode = (argc >= 5) ? argv[4] : "transport";
+    unsigned seed = (argc >= 6) ? static_cast<unsigned>(std::stoul(argv[5])) : 0u;
+    if (mode != "transport" && mode != "direct" && mode != "validate") {
+        G4cerr << "Unknown mode '" << mode << "'" << G4endl;
+        return 1;
+    }
+    // La validation compare deux passes qui doivent tirer les mêmes particules
+    if (mode == "validate" && seed == 0) seed = std::random_device{}() | 1u;
 
     // ────────────────────────────────────────
     // 1) Lecture du fichier openPMD pour compter les particules
@@ -45,9 +71,51 @@ int main(int argc, char** argv)
     // 2) Initialisation Geant4
     auto* runManager = new G4RunManager;
 
-    runManager->SetUserInitialization(new MyDetectorConstruction());
+    auto* detector = new MyDetectorConstruction();
+    runManager->SetUserInitialization(detector);
     runManager->SetUserInitialization(new FTFP_BERT);
-    runManager->SetUserInitialization(new MyActionInitialization(openPMD_path, species, iteration));
+    runManager->SetUserInitialization(new MyActionInitialization(openPMD_path, species, iteration, seed));
+
+    // Le générateur (construit ci-dessus) porte les particules filtrées
+    const auto* generator = dynamic_cast<const MyPrimaryGenerator*>(
+        runManager->GetUserPrimaryGeneratorAction());
+    const wxg4::ParticleData& pdata = generator->GetParticleData();
+
+    // Lecture directe : mêmes tirages que le générateur, hits calculés
+    // analytiquement (position du gun = origine)
+    auto directReadout = [&](wxg4::DirectHits& hits) {
+        std::mt19937 gen(seed ? seed : std::random_device{}());
+        const auto t0 = std::chrono::steady_clock::now();
+        const auto picks = wxg4::draw_indices(pdata, nEvents, gen);
+        wxg4::direct_readout(pdata, picks, {0., 0., 0.},
+                             detector->GetRadii(), detector->GetShellThickness(), hits);
+        const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        G4cout << "[direct] " << nEvents << " primaires, " << hits.event.size()
+               << " hits en " << dt.count() << " s ("
+               << (dt.count() > 0. ? nEvents / dt.count() : 0.) << " particules/s)" << G4endl;
+    };
+
+    if (mode == "direct") {
+        // ────────────────────────────────────────
+        // 3) Pas de transport : même ntuple, écrit via le RunAction
+        wxg4::DirectHits hits;
+        directReadout(hits);
+
+        MyRunAction writer;
+        writer.BeginOfRunAction(nullptr);
+        auto* man = G4AnalysisManager::Instance();
+        for (std::size_t h = 0; h < hits.event.size(); ++h) {
+            man->FillNtupleIColumn(0, static_cast<G4int>(hits.event[h]));
+            man->FillNtupleDColumn(1, hits.px[h]);
+            man->FillNtupleDColumn(2, hits.py[h]);
+            man->FillNtupleDColumn(3, hits.pz[h]);
+            man->AddNtupleRow(0);
+        }
+        writer.EndOfRunAction(nullptr);
+
+        delete runManager;
+        return 0;
+    }
 
     runManager->Initialize();
 
@@ -55,6 +123,46 @@ int main(int argc, char** argv)
     // 3) BeamOn avec 10% des particules
     runManager->BeamOn(nEvents);
 
+    if (mode == "validate") {
+        // ────────────────────────────────────────
+        // 4) Relecture de output.root et comparaison avec la lecture directe
+        wxg4::DirectHits hits;
+        directReadout(hits);
+        std::map<G4int, std::size_t> expected;
+        for (std::size_t h = 0; h < hits.event.size(); ++h) {
+            expected[static_cast<G4int>(hits.event[h])] = h;
+        }
+
+        auto* reader = G4RootAnalysisReader::Instance();
+        reader->SetFileName("output.root");
+        const G4int ntupleId = reader->GetNtuple("momenta");
+        G4int eventID = 0;
+        G4double px = 0., py = 0., pz = 0.;
+        reader->SetNtupleIColumn(ntupleId, "eventID", eventID);
+        reader->SetNtupleDColumn(ntupleId, "px", px);
+        reader->SetNtupleDColumn(ntupleId, "py", py);
+        reader->SetNtupleDColumn(ntupleId, "pz", pz);
+
+        std::size_t rows = 0, matched = 0;
+        double maxRel = 0.;
+        while (reader->GetNtupleRow(ntupleId)) {
+            ++rows;
+            auto e = expected.find(eventID);
+            if (e == expected.end()) continue;
+            ++matched;
+            const std::size_t h = e->second;
+            const double p  = std::sqrt(hits.px[h]*hits.px[h] + hits.py[h]*hits.py[h]
+                                      + hits.pz[h]*hits.pz[h]);
+            const double dp = std::sqrt((px - hits.px[h])*(px - hits.px[h])
+                                      + (py - hits.py[h])*(py - hits.py[h])
+                                      + (pz - hits.pz[h])*(pz - hits.pz[h]));
+            if (p > 0.) maxRel = std::max(maxRel, dp / p);
+        }
+        G4cout << "[validate] transport : " << rows << " hits, direct : "
+               << hits.event.size() << " hits, appariés : " << matched
+               << ", écart relatif max |Δp|/p = " << maxRel << G4endl;
+    }
+
     delete runManager;
     return 0;
 }
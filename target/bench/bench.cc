@@ -0,0 +1,389 @@
+// bench/bench.cc
+//
+// Banc d'essai de la chaîne de lecture : écrit une série openPMD synthétique
+// (impulsions gaussiennes comme generate.ipynb, poids variables), puis
+// chronomètre chaque étape du programme principal et écrit un rapport JSON.
+// draw_split / draw_records comparent le tirage d'un primaire dans les
+// colonnes de ParticleData et dans les fiches de PrimaryTable.
+//
+//   wxg4_bench [--particles N] [--events M] [--backend bp5|h5]
+//              [--repeat R] [--pnorm MeV/c] [--dir D] [--json out.json]
+//              [--keep] [--verbose]
+//
+// Les traces de débogage (std::cout) sont coupées pendant les mesures,
+// sauf avec --verbose.
+#include <G4Electron.hh>
+#include <G4Positron.hh>
+#include <G4Gamma.hh>
+#include <G4Proton.hh>
+#include <G4Event.hh>
+#include <G4AnalysisManager.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <openPMD/openPMD.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+#include "primary.hh"
+#include "sampling.hh"
+#include "options.hh"
+#include "generator.hh"
+#include "source.hh"
+#include "run.hh"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr int         kIteration = 100;
+constexpr const char* kSpecies   = "electrons";
+constexpr double      kTcut_MeV  = 50.0;    // même coupure que le générateur
+constexpr std::uint64_t kChunk   = 10'000'000; // écriture par blocs (1e8 → 3 Go sinon)
+
+struct BenchConfig {
+    std::uint64_t particles = 1'000'000;
+    std::uint64_t events    = 100'000;
+    std::string   backend   = "bp5";
+    int           repeat    = 3;
+    double        pnorm_MeV = 60.0;   // norme moyenne de p (une partie passe T > 50 MeV)
+    std::string   dir;
+    std::string   json      = "bench.json";
+    bool          keep      = false;
+    bool          verbose   = false;
+};
+
+struct StageResult {
+    std::string   name;
+    std::uint64_t items = 0;       // éléments traités par répétition
+    std::vector<double> seconds;   // une valeur par répétition
+};
+
+/// Coupe std::cout pendant sa durée de vie (operator<< ne formate plus rien)
+class QuietCout {
+public:
+    explicit QuietCout(bool active)
+    : fOld(active ? std::cout.rdbuf(nullptr) : nullptr), fActive(active) {}
+    ~QuietCout()
+    {
+        if (fActive) {
+            std::cout.rdbuf(fOld);
+            std::cout.clear();
+        }
+    }
+private:
+    std::streambuf* fOld;
+    bool            fActive;
+};
+
+/// Répète `body` R fois ; `setup` (non chronométré) précède chaque mesure
+StageResult time_stage(const BenchConfig& cfg, const std::string& name,
+                       std::uint64_t items,
+                       const std::function<void()>& setup,
+                       const std::function<void()>& body)
+{
+    StageResult res{name, items, {}};
+    for (int r = 0; r < cfg.repeat; ++r) {
+        QuietCout quiet(!cfg.verbose);
+        if (setup) setup();
+        const auto t0 = std::chrono::steady_clock::now();
+        body();
+        const std::chrono::duration<double> dt =
+            std::chrono::steady_clock::now() - t0;
+        res.seconds.push_back(dt.count());
+    }
+    return res;
+}
+
+void write_synthetic_series(const BenchConfig& cfg, const std::string& path)
+{
+    openPMD::Series series(path, openPMD::Access::CREATE);
+    auto it = series.iterations[kIteration];
+    auto sp = it.particles[kSpecies];
+
+    const std::uint64_t N = cfg.particles;
+    const openPMD::Dataset ds(openPMD::Datatype::DOUBLE, {N});
+    for (const char* c : {"x", "y", "z"}) {
+        sp["momentum"][c].resetDataset(ds);
+        sp["momentum"][c].setUnitSI(1.0);
+    }
+    auto& w = sp["weighting"][openPMD::RecordComponent::SCALAR];
+    w.resetDataset(ds);
+    w.setUnitSI(1.0);
+
+    // Mêmes lois que generate.ipynb : composantes ~ N(±10, σ), σ = P/1.59577
+    std::mt19937_64 gen(12345);
+    const double sigma = cfg.pnorm_MeV / 1.59577;
+    std::normal_distribution<double> nx(10.0, sigma), ny(-10.0, sigma), nz(0.0, sigma);
+    std::uniform_real_distribution<double> uw(0.5, 1.5);
+
+    for (std::uint64_t off = 0; off < N; off += kChunk) {
+        const std::uint64_t n = std::min(kChunk, N - off);
+        auto px = std::shared_ptr<double>(new double[n], std::default_delete<double[]>());
+        auto py = std::shared_ptr<double>(new double[n], std::default_delete<double[]>());
+        auto pz = std::shared_ptr<double>(new double[n], std::default_delete<double[]>());
+        auto ww = std::shared_ptr<double>(new double[n], std::default_delete<double[]>());
+        for (std::uint64_t i = 0; i < n; ++i) {
+            px.get()[i] = nx(gen) * wxg4::MEV_C_CONVERSION;
+            py.get()[i] = ny(gen) * wxg4::MEV_C_CONVERSION;
+            pz.get()[i] = nz(gen) * wxg4::MEV_C_CONVERSION;
+            ww.get()[i] = uw(gen);
+        }
+        sp["momentum"]["x"].storeChunk(px, {off}, {n});
+        sp["momentum"]["y"].storeChunk(py, {off}, {n});
+        sp["momentum"]["z"].storeChunk(pz, {off}, {n});
+        w.storeChunk(ww, {off}, {n});
+        series.flush();
+    }
+    series.close();
+}
+
+void write_json(const BenchConfig& cfg, const std::string& path,
+                const std::vector<StageResult>& stages)
+{
+    std::ofstream out(cfg.json);
+    out << "{\n"
+        << "  \"config\": {\n"
+        << "    \"dataset\": \"" << path << "\",\n"
+        << "    \"backend\": \"" << cfg.backend << "\",\n"
+        << "    \"particles\": " << cfg.particles << ",\n"
+        << "    \"events\": " << cfg.events << ",\n"
+        << "    \"repeat\": " << cfg.repeat << ",\n"
+        << "    \"pnorm_MeV\": " << cfg.pnorm_MeV << "\n"
+        << "  },\n"
+        << "  \"stages\": [\n";
+    for (std::size_t s = 0; s < stages.size(); ++s) {
+        const auto& st = stages[s];
+        const double tmin = *std::min_element(st.seconds.begin(), st.seconds.end());
+        const double tmean = std::accumulate(st.seconds.begin(), st.seconds.end(), 0.0)
+                           / static_cast<double>(st.seconds.size());
+        out << "    {\"name\": \"" << st.name << "\""
+            << ", \"items\": " << st.items
+            << ", \"min_s\": " << tmin
+            << ", \"mean_s\": " << tmean
+            << ", \"items_per_s\": " << (tmin > 0. ? st.items / tmin : 0.)
+            << ", \"runs_s\": [";
+        for (std::size_t r = 0; r < st.seconds.size(); ++r) {
+            out << (r ? ", " : "") << st.seconds[r];
+        }
+        out << "]}" << (s + 1 < stages.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+bool parse_bench_args(int argc, char** argv, BenchConfig& cfg)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if      (a == "--keep")    cfg.keep = true;
+        else if (a == "--verbose") cfg.verbose = true;
+        else if (a == "--particles" && (v = next())) cfg.particles = static_cast<std::uint64_t>(std::stod(v));
+        else if (a == "--events"    && (v = next())) cfg.events    = static_cast<std::uint64_t>(std::stod(v));
+        else if (a == "--backend"   && (v = next())) cfg.backend   = v;
+        else if (a == "--repeat"    && (v = next())) cfg.repeat    = std::max(1, std::atoi(v));
+        else if (a == "--pnorm"     && (v = next())) cfg.pnorm_MeV = std::stod(v);
+        else if (a == "--dir"       && (v = next())) cfg.dir       = v;
+        else if (a == "--json"      && (v = next())) cfg.json      = v;
+        else return false;
+    }
+    return (cfg.backend == "bp5" || cfg.backend == "h5")
+        && cfg.particles > 0 && cfg.events > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchConfig cfg;
+    if (!parse_bench_args(argc, argv, cfg)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--particles N] [--events M] [--backend bp5|h5]"
+                     " [--repeat R] [--pnorm MeV/c] [--dir D] [--json out.json]"
+                     " [--keep] [--verbose]\n";
+        return 1;
+    }
+
+    const fs::path dir = cfg.dir.empty()
+        ? fs::temp_directory_path() / "wxg4_bench"
+        : fs::path(cfg.dir);
+    fs::create_directories(dir);
+    const std::string path = (dir / ("synthetic." + cfg.backend)).string();
+    cfg.json = fs::absolute(cfg.json).string();
+
+    // Particules Geant4 nécessaires au générateur (pas de liste physique ici)
+    G4Electron::Definition();
+    G4Positron::Definition();
+    G4Gamma::Definition();
+    G4Proton::Definition();
+
+    std::vector<StageResult> stages;
+    std::cout << "[bench] " << cfg.particles << " particules, "
+              << cfg.events << " événements, " << path << "\n";
+
+    // 0) Jeu de données synthétique
+    stages.push_back(time_stage(cfg, "write_dataset", cfg.particles, nullptr,
+        [&] { write_synthetic_series(cfg, path); }));
+
+    // 1) Ouverture de la série et lecture des métadonnées (comme main)
+    stages.push_back(time_stage(cfg, "series_open", 1, nullptr, [&] {
+        openPMD::Series series(path, openPMD::Access::READ_ONLY,
+                               wxg4::OPENPMD_READ_OPTIONS);
+        auto it = series.iterations[kIteration];
+        it.open();
+        (void)it.particles[kSpecies]["momentum"]["x"].getExtent();
+    }));
+
+    // 2) Chargement des records depuis la série déjà ouverte
+    const std::vector<wxg4::SpeciesSpec> species{{kSpecies, "e-"}};
+    wxg4::ParticleData raw;
+    std::unique_ptr<openPMD::Series> series;
+    stages.push_back(time_stage(cfg, "record_load", cfg.particles,
+        [&] {
+            series = std::make_unique<openPMD::Series>(
+                path, openPMD::Access::READ_ONLY, wxg4::OPENPMD_READ_OPTIONS);
+        },
+        [&] { raw = wxg4::read_particle_data_3d(*series, species, kIteration); }));
+    series.reset();
+
+    // 3) Filtre T > 50 MeV (sur une copie fraîche à chaque répétition)
+    const std::vector<double> masses{G4Electron::Definition()->GetPDGMass() / MeV};
+    wxg4::ParticleData pdata;
+    std::size_t kept = 0;
+    stages.push_back(time_stage(cfg, "filter", raw.px.size(),
+        [&] { pdata = raw; },
+        [&] { kept = wxg4::filter_kinetic_energy(pdata, masses, kTcut_MeV); }));
+    std::cout << "[bench] filtre : " << kept << " / " << raw.px.size() << "\n";
+    raw = wxg4::ParticleData{};
+    if (pdata.px.empty()) {
+        std::cerr << "[bench] aucune particule après filtrage\n";
+        return 1;
+    }
+
+    // 4) Construction de la CDF (somme cumulée des poids individuels)
+    std::vector<double> weights(pdata.ws.size());
+    std::adjacent_difference(pdata.ws.begin(), pdata.ws.end(), weights.begin());
+    stages.push_back(time_stage(cfg, "cdf_build", weights.size(), nullptr,
+        [&] { std::partial_sum(weights.begin(), weights.end(), pdata.ws.begin()); }));
+
+    // 5) Tirages : recherche dichotomique par événement, puis index systématique
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    std::size_t sink = 0;
+    stages.push_back(time_stage(cfg, "sample_random", cfg.events, nullptr, [&] {
+        for (std::uint64_t e = 0; e < cfg.events; ++e) {
+            sink += wxg4::sample_index_3d(pdata, u01(gen));
+        }
+    }));
+    stages.push_back(time_stage(cfg, "sample_systematic", cfg.events, nullptr, [&] {
+        sink += wxg4::build_sample_index(
+            pdata, cfg.events, wxg4::Sampler::Systematic, gen).size();
+    }));
+
+    // 5b) Tirage + impulsion du primaire, hors Geant4 : colonnes séparées
+    // (dichotomie sur ws, px/py/pz, norme et direction recalculées) contre
+    // fiches de 32 octets (alias, direction et |p| précalculés)
+    const std::uint64_t draws = std::max<std::uint64_t>(cfg.events, 10'000'000);
+    double acc = 0.;
+    stages.push_back(time_stage(cfg, "draw_split", draws, nullptr, [&] {
+        const double total = pdata.ws.back();
+        for (std::uint64_t e = 0; e < draws; ++e) {
+            const auto it = std::lower_bound(pdata.ws.begin(), pdata.ws.end(), u01(gen) * total);
+            const std::size_t i = std::min<std::size_t>(it - pdata.ws.begin(), pdata.ws.size() - 1);
+            const double px = pdata.px[i] / wxg4::MEV_C_CONVERSION;
+            const double py = pdata.py[i] / wxg4::MEV_C_CONVERSION;
+            const double pz = pdata.pz[i] / wxg4::MEV_C_CONVERSION;
+            const double p  = std::sqrt(px * px + py * py + pz * pz);
+            acc += p + pz / p;
+        }
+    }));
+    wxg4::PrimaryTable table;
+    stages.push_back(time_stage(cfg, "primary_table_build", pdata.px.size(), nullptr,
+        [&] { table.Build(pdata); }));
+    stages.push_back(time_stage(cfg, "draw_records", draws, nullptr, [&] {
+        for (std::uint64_t e = 0; e < draws; ++e) {
+            const wxg4::PrimaryRecord& r = table[table.Draw(u01(gen))];
+            acc += r.p + r.dz;
+        }
+    }));
+    sink += static_cast<std::size_t>(acc) & 1;
+    table.Clear();
+
+    // 6) Générateur complet : initialisation puis GeneratePrimaries
+    wxg4::RunOptions opts;
+    opts.dataset   = path;
+    opts.species   = species;
+    opts.iteration = kIteration;
+    opts.nEvents   = cfg.events;
+    std::unique_ptr<wxg4::ParticleSource> source;
+    std::unique_ptr<MyPrimaryGenerator> generator;
+    stages.push_back(time_stage(cfg, "generator_init", cfg.particles,
+        [&] { generator.reset(); source.reset(); },
+        [&] {
+            source = std::make_unique<wxg4::ParticleSource>();
+            source->Load(opts, nullptr);
+            source->PrepareRun(cfg.events, opts.sampler);
+            generator = std::make_unique<MyPrimaryGenerator>(*source);
+        }));
+    stages.push_back(time_stage(cfg, "generate_primaries", cfg.events, nullptr, [&] {
+        for (std::uint64_t e = 0; e < cfg.events; ++e) {
+            G4Event evt(static_cast<G4int>(e));
+            generator->GeneratePrimaries(&evt);
+        }
+    }));
+    generator.reset();
+    source.reset();
+
+    // 7) Remplissage du ntuple, comme MyRunAction::FlushHits
+    const fs::path cwd = fs::current_path();
+    fs::current_path(dir);
+    {
+        MyRunAction run("bench");
+        auto* man = G4AnalysisManager::Instance();
+        stages.push_back(time_stage(cfg, "ntuple_fill", cfg.events,
+            [&] { run.BeginOfRunAction(nullptr); },
+            [&] {
+                for (std::uint64_t e = 0; e < cfg.events; ++e) {
+                    const std::size_t i = e % pdata.px.size();
+                    man->FillNtupleIColumn(0, static_cast<G4int>(e));
+                    man->FillNtupleDColumn(1, pdata.px[i] / wxg4::MEV_C_CONVERSION);
+                    man->FillNtupleDColumn(2, pdata.py[i] / wxg4::MEV_C_CONVERSION);
+                    man->FillNtupleDColumn(3, pdata.pz[i] / wxg4::MEV_C_CONVERSION);
+                    man->FillNtupleDColumn(4, 1.0);
+                    man->AddNtupleRow(0);
+                }
+                QuietCout quiet(!cfg.verbose);
+                run.EndOfRunAction(nullptr);
+            }));
+    }
+    fs::current_path(cwd);
+
+    write_json(cfg, path, stages);
+    for (const auto& st : stages) {
+        const double tmin = *std::min_element(st.seconds.begin(), st.seconds.end());
+        std::cout << "[bench] " << st.name << " : " << 1e3 * tmin << " ms ("
+                  << (tmin > 0. ? st.items / tmin : 0.) << " /s)\n";
+    }
+    std::cout << "[bench] rapport : " << cfg.json << " (contrôle " << sink % 10 << ")\n";
+
+    if (!cfg.keep) {
+        fs::remove_all(dir / ("synthetic." + cfg.backend));
+        fs::remove(dir / "output.root");
+    }
+    return 0;
+}
@@ -0,0 +1,241 @@
+// python/wxg4py.cc
+//
+// Module Python "wxg4" : la lecture openPMD, le filtre en énergie, le tri
+// et les tirages du programme principal, sans réécriture en NumPy/pandas.
+// Les colonnes du stockage (px, py, pz, ws, sid, ek, wb) sont des vues
+// NumPy sur les vecteurs C++, sans copie ; elles gardent le stockage en
+// vie. Un stockage n'est jamais modifié une fois rendu à Python :
+// filter() et sort() renvoient un nouvel objet Particles et laissent
+// l'ancien (et ses vues) intact.
+//
+//   import wxg4
+//   d = wxg4.read("diags/openpmd_%T.bp", "electrons,positrons", 100)
+//   d = wxg4.filter(d, wxg4.particle_masses("electrons,positrons"), 50.0)
+//   ek, w = d.ek, d.weights()                  # MeV, poids par particule
+//   idx = wxg4.sample_index(d, 100000, "systematic", seed=1)
+//   pz_MeV = d.pz[idx] / wxg4.MEV_C_CONVERSION
+//   s = wxg4.reservoir_sample(path, "electrons", 100, 0.01, [0.511])  # > RAM
+//
+// Construit avec -DWXG4_BUILD_PYTHON=ON ; ajouter le dossier de build
+// au PYTHONPATH.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <G4ParticleTable.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4Electron.hh>
+#include <G4Positron.hh>
+#include <G4Gamma.hh>
+#include <G4Proton.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+#include "reorder.hh"
+#include "reservoir.hh"
+#include "sampling.hh"
+#include "shard.hh"
+
+namespace py = pybind11;
+
+namespace
+{
+
+/// Vue NumPy sur une colonne ; owner (l'objet Python du stockage) reste en
+/// vie, et ses colonnes ne sont jamais réallouées (filter/sort copient)
+template <typename T>
+py::array_t<T> column_view(std::vector<T>& column, py::handle owner)
+{
+    return py::array_t<T>(static_cast<py::ssize_t>(column.size()), column.data(), owner);
+}
+
+/// Tableau NumPy propriétaire d'un vecteur déplacé, sans copie
+template <typename T>
+py::array_t<T> adopt(std::vector<T>&& v)
+{
+    auto* heap = new std::vector<T>(std::move(v));
+    py::capsule owner(heap, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+    return py::array_t<T>(static_cast<py::ssize_t>(heap->size()), heap->data(), owner);
+}
+
+wxg4::Shard to_shard(const std::string& text)
+{
+    wxg4::Shard shard;
+    if (!text.empty() && !wxg4::parse_shard(text, shard)) {
+        throw std::invalid_argument("shard expects k/N with 0 <= k < N (got '" + text + "')");
+    }
+    return shard;
+}
+
+/// Masse [MeV] de chaque espèce, particule Geant4 déduite comme dans ParticleSource
+std::vector<double> particle_masses(const std::string& species)
+{
+    // Tables de particules hors run manager : les définitions usuelles suffisent
+    G4Electron::Definition();
+    G4Positron::Definition();
+    G4Gamma::Definition();
+    G4Proton::Definition();
+
+    const auto specs = wxg4::parse_species_list(species);
+    auto* table = G4ParticleTable::GetParticleTable();
+    std::vector<double> masses;
+    for (const auto& sp : specs) {
+        const std::string g4name = (sp.g4name.empty() && specs.size() == 1) ? "e-" : sp.g4name;
+        G4ParticleDefinition* def = g4name.empty() ? nullptr : table->FindParticle(g4name);
+        if (def == nullptr) {
+            throw std::invalid_argument("species '" + sp.name + "': unknown Geant4 particle '"
+                                        + g4name + "' (use name:particle, e.g. "
+                                        + sp.name + ":e-)");
+        }
+        masses.push_back(def->GetPDGMass() / MeV);
+    }
+    return masses;
+}
+
+} // namespace
+
+PYBIND11_MODULE(wxg4, m)
+{
+    m.doc() = "Lecture, filtrage et tirage des particules WarpX (chaîne de read_warpx_particles)";
+    m.attr("MEV_C_CONVERSION") = wxg4::MEV_C_CONVERSION;
+
+    py::class_<wxg4::ParticleData>(m, "Particles",
+        "Stockage des particules ; colonnes exposées en vues NumPy sans copie")
+        .def(py::init<>())
+        .def("__len__", [](const wxg4::ParticleData& d) { return d.px.size(); })
+        .def_property_readonly("px",  [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().px, self); },
+            "impulsion x [kg·m/s]")
+        .def_property_readonly("py",  [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().py, self); },
+            "impulsion y [kg·m/s]")
+        .def_property_readonly("pz",  [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().pz, self); },
+            "impulsion z [kg·m/s]")
+        .def_property_readonly("ws",  [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().ws, self); },
+            "poids cumulés (tirage)")
+        .def_property_readonly("sid", [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().sid, self); },
+            "indice d'espèce dans la liste lue")
+        .def_property_readonly("ek",  [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().ek, self); },
+            "énergie cinétique [MeV], remplie par filter()")
+        .def_property_readonly("wb",  [](py::object self) {
+            return column_view(self.cast<wxg4::ParticleData&>().wb, self); },
+            "poids compensatoire du biais (vide = 1)")
+        .def_readonly("energy_sorted", &wxg4::ParticleData::energy_sorted)
+        .def("weights", [](const wxg4::ParticleData& d) {
+                // Différences des poids cumulés : seule colonne calculée (copie)
+                std::vector<double> w(d.ws.size());
+                for (std::size_t i = 0; i < w.size(); ++i) w[i] = d.ws[i] - (i ? d.ws[i - 1] : 0.);
+                return adopt(std::move(w));
+            },
+            "poids de chaque particule (nouveau tableau)");
+
+    m.def("read",
+        [](const std::string& path, const std::string& species, int iteration,
+           const std::string& shard) {
+            return wxg4::read_particle_data_3d(path, wxg4::parse_species_list(species),
+                                               iteration, to_shard(shard));
+        },
+        py::arg("path"), py::arg("species"), py::arg("iteration"), py::arg("shard") = "",
+        py::call_guard<py::gil_scoped_release>(),
+        "Lit une ou plusieurs espèces (\"electrons,positrons:e+\") d'une itération ; "
+        "shard = \"k/N\" pour la seule tranche k");
+
+    m.def("reservoir_sample",
+        [](const std::string& path, const std::string& species, int iteration, double fraction,
+           const std::vector<double>& masses, double Tcut_MeV, std::uint64_t seed,
+           unsigned threads, const std::string& shard) {
+            const auto specs = wxg4::parse_species_list(species);
+            if (masses.size() != specs.size()) {
+                throw std::invalid_argument("masses: one entry per species");
+            }
+            wxg4::ReservoirParams params;
+            params.masses_MeV = masses;
+            params.Tcut_MeV   = Tcut_MeV;
+            params.fraction   = fraction;
+            params.seed       = seed;
+            params.threads    = threads;
+            return wxg4::reservoir_sample_3d(path, specs, iteration, params, to_shard(shard));
+        },
+        py::arg("path"), py::arg("species"), py::arg("iteration"), py::arg("fraction"),
+        py::arg("masses"), py::arg("Tcut_MeV") = 50.0, py::arg("seed") = 0,
+        py::arg("threads") = 1, py::arg("shard") = "",
+        py::call_guard<py::gil_scoped_release>(),
+        "Échantillon pondéré de fraction x enregistrements en une lecture par blocs "
+        "(filtre T > Tcut_MeV compris) ; poids de l'échantillon dans wb");
+
+    m.def("particle_masses", &particle_masses, py::arg("species"),
+        "Masses [MeV] des particules Geant4 associées aux espèces");
+
+    m.def("filter",
+        [](const wxg4::ParticleData& d, const std::vector<double>& masses, double Tcut_MeV) {
+            if (masses.empty()) throw std::invalid_argument("masses: one entry per species");
+            wxg4::ParticleData out = d;
+            wxg4::filter_kinetic_energy(out, masses, Tcut_MeV);
+            return out;
+        },
+        py::arg("particles"), py::arg("masses"), py::arg("Tcut_MeV") = 50.0,
+        py::call_guard<py::gil_scoped_release>(),
+        "Nouveau stockage des particules avec T > Tcut_MeV (filtre du générateur), ek rempli ; "
+        "l'entrée n'est pas modifiée");
+
+    m.def("sort",
+        [](const wxg4::ParticleData& d, const std::string& key) {
+            wxg4::SortKey k;
+            if (!wxg4::parse_sort_key(key, k)) {
+                throw std::invalid_argument("sort key expects none, energy or direction");
+            }
+            if (d.ek.size() != d.px.size()) throw std::invalid_argument("sort requires filter() first");
+            py::gil_scoped_release release;
+            wxg4::ParticleData out = d;
+            wxg4::sort_particles(out, k);
+            return out;
+        },
+        py::arg("particles"), py::arg("key") = "energy",
+        "Nouveau stockage réordonné (none | energy | direction) ; l'entrée n'est pas modifiée");
+
+    m.def("sample_index",
+        [](const wxg4::ParticleData& d, std::size_t n, const std::string& sampler,
+           std::uint64_t seed) {
+            wxg4::Sampler scheme;
+            if (!wxg4::parse_sampler(sampler, scheme)) {
+                throw std::invalid_argument("sampler expects random, systematic or stratified");
+            }
+            if (d.ws.empty() || d.ws.back() <= 0.) {
+                throw std::invalid_argument("no particle weight to sample from");
+            }
+            std::mt19937 gen(seed ? static_cast<std::mt19937::result_type>(wxg4::stream_seed(seed, 0))
+                                  : std::random_device{}());
+            std::vector<std::uint32_t> index;
+            {
+                py::gil_scoped_release release;
+                if (scheme == wxg4::Sampler::Random) {
+                    // Tirage avec remise, un par événement : dichotomie sur ws
+                    std::uniform_real_distribution<double> dist(0.0, 1.0);
+                    const double total = d.ws.back();
+                    index.resize(n);
+                    for (auto& i : index) {
+                        const auto it = std::lower_bound(d.ws.begin(), d.ws.end(), dist(gen) * total);
+                        i = static_cast<std::uint32_t>(
+                            std::min<std::size_t>(it - d.ws.begin(), d.ws.size() - 1));
+                    }
+                } else {
+                    index = wxg4::build_sample_index(d, n, scheme, gen);
+                }
+            }
+            return adopt(std::move(index));
+        },
+        py::arg("particles"), py::arg("n"), py::arg("sampler") = "systematic", py::arg("seed") = 0,
+        "Indices de n particules tirées selon les poids, comme les événements d'un run");
+}
@@ -1,28 +1,131 @@
 #include "action.hh"
 #include "generator.hh"
 #include "run.hh"
+#include "event.hh"
+#include "stepping.hh"
+#include "stacking.hh"
+#include "tracking.hh"
+#include "fastsim.hh"
+
+#include <G4SystemOfUnits.hh>
+#include <G4ParticleTable.hh>
+#include <G4ParticleDefinition.hh>
+#include <cmath>
 
 MyActionInitialization::MyActionInitialization(
-    const std::string& dataset,
-    const std::string& species,
-    int iteration
+    const wxg4::RunOptions& opts,
+    const MyDetectorConstruction* detector,
+    const wxg4::ParticleSource* source
 )
 : G4VUserActionInitialization()
-, m_dataset(dataset)
-, m_species(species)
-, m_iteration(iteration)
+, m_opts(opts)
+, m_detector(detector)
+, m_source(source)
 {}
 
+void MyActionInitialization::BuildForMaster() const
+{
+    auto* runAction = new MyRunAction(wxg4::physics_label(m_opts), m_opts.profile);
+    runAction->SetResponseFile(m_opts.response);
+    runAction->SetTransmissionFile(m_opts.calibrateTarget);
+    SetUserAction(runAction);
+}
+
+void MyActionInitialization::BuildCalibration() const
+{
+    std::vector<G4ParticleDefinition*> particles;
+    std::vector<int> pdgs;
+    for (const auto& name : m_opts.calibrateParticles) {
+        auto* def = G4ParticleTable::GetParticleTable()->FindParticle(name);
+        if (def == nullptr) {
+            G4Exception("MyActionInitialization", "UnknownParticle", FatalErrorInArgument,
+                        ("--calibrate-particles " + name).c_str());
+            return;
+        }
+        particles.push_back(def);
+        pdgs.push_back(def->GetPDGEncoding());
+    }
+    auto* kernel = new wxg4::TransmissionKernel(m_opts.calibrateParticles, pdgs,
+                                                m_opts.calibrateEnergy, m_opts.calibrateAngle,
+                                                m_opts.thickness_mm);
+
+    std::cout << "[ActionInit] Calibration de la cible : " << particles.size()
+              << " particule(s) x " << kernel->Binning().NIn() << " bins\n";
+    SetUserAction(new MyResponseGenerator(kernel->Binning(), particles,
+                                          m_opts.calibrateHistories));
+    auto* runAction = new MyRunAction(wxg4::physics_label(m_opts), m_opts.profile);
+    runAction->SetTransmission(kernel);
+    runAction->SetTransmissionFile(m_opts.calibrateTarget);
+    SetUserAction(runAction);
+    SetUserAction(new MyEventAction(runAction));
+    SetUserAction(new MyTrackingAction());
+    SetUserAction(new MyCalibrationSteppingAction(m_detector, kernel));
+}
+
 void MyActionInitialization::Build() const
 {
+    if (!m_opts.calibrateTarget.empty()) {
+        BuildCalibration();
+        return;
+    }
+    const bool response = !m_opts.response.empty();
+
     std::cout << "[ActionInit] Enregistrement du PrimaryGenerator\n";
-    // Register primary generator
-    SetUserAction(new MyPrimaryGenerator(
-        m_dataset,
-        m_species,
-        m_iteration
-    ));
+    // Register primary generator (mode réponse : bins mono-énergétiques)
+    wxg4::ResponseBinning bins;
+    G4ParticleDefinition* particle = nullptr;
+    if (response) {
+        bins = wxg4::response_binning(m_opts);
+        particle = G4ParticleTable::GetParticleTable()->FindParticle(m_opts.responseParticle);
+        if (particle == nullptr) {
+            G4Exception("MyActionInitialization", "UnknownParticle", FatalErrorInArgument,
+                        ("--response-particle " + m_opts.responseParticle).c_str());
+            return;
+        }
+        SetUserAction(new MyResponseGenerator(bins, {particle}, m_opts.responseEvents));
+    } else {
+        SetUserAction(new MyPrimaryGenerator(*m_source, !m_opts.checkpointDir.empty()));
+    }
     // Register run action
     std::cout << "[ActionInit] Enregistrement du RunAction\n";
-    SetUserAction(new MyRunAction());
+    auto* runAction = new MyRunAction(wxg4::physics_label(m_opts), m_opts.profile);
+    runAction->SetFlushPeriod(m_opts.flushEvery);
+    runAction->SetResponseFile(m_opts.response);
+    SetUserAction(runAction);
+
+    // Temps par événement, traces et pas (profil du run) ; en mode réponse,
+    // hits versés dans la matrice de ce thread
+    wxg4::ResponseMatrix* matrix = nullptr;
+    if (response) {
+        matrix = new wxg4::ResponseMatrix(bins, particle->GetParticleName(),
+                                          particle->GetPDGMass() / MeV);
+        runAction->SetResponse(matrix);
+    }
+    SetUserAction(new MyEventAction(runAction, matrix, m_opts.responseEvents));
+    SetUserAction(new MyTrackingAction());
+
+    // Arrêt anticipé des traces qui ne peuvent plus produire de hit
+    KillCuts cuts;
+    cuts.geometry  = m_opts.killGeometry;
+    cuts.emin      = m_opts.killEmin_MeV * MeV;
+    cuts.cosCone   = (m_opts.killCone_deg < 180.)
+                   ? std::cos(m_opts.killCone_deg * deg) : -1.;
+    cuts.detector  = m_detector;
+    const bool kill = cuts.geometry || cuts.emin > 0. || cuts.cosCone > -1.;
+
+    // Profil par volume : une table par thread, tenue par le SteppingAction
+    wxg4::VolumeProfiler* volumes = nullptr;
+    if (m_opts.volumeSamplePeriod > 0) {
+        volumes = new wxg4::VolumeProfiler(m_opts.volumeSamplePeriod);
+        runAction->SetVolumeProfiler(volumes);
+    }
+
+    if (kill || volumes) {
+        std::cout << "[ActionInit] Enregistrement du SteppingAction\n";
+        SetUserAction(new MySteppingAction(cuts, runAction, volumes));
+    }
+    if (kill) {
+        std::cout << "[ActionInit] Enregistrement du StackingAction\n";
+        SetUserAction(new MyStackingAction(cuts, runAction));
+    }
 }
\ No newline at end of file
@@ -3,28 +3,37 @@
 #define ACTION_HH
 
 #include <G4VUserActionInitialization.hh>
-#include <string>
+#include "options.hh"
+
+class MyDetectorConstruction;
+namespace wxg4 { class ParticleSource; }
 
 class MyActionInitialization : public G4VUserActionInitialization
 {
 public:
     /**
-     * @param dataset    Chemin vers le dossier OpenPMD (ex: "../3D_dataset")
-     * @param species    Nom de l’espèce dans OpenPMD (ex: "electrons")
-     * @param iteration  Numéro d’itération à lire (ex: 100)
+     * @param opts      Paramètres du run, tenus à jour par main/MyMessenger
+     *                  (lus à la construction des actions de chaque thread)
+     * @param detector  géométrie (épaisseur courante de la cible)
+     * @param source    particules primaires, partagées par tous les threads
      */
-    MyActionInitialization(const std::string& dataset,
-                           const std::string& species,
-                           int iteration);
+    MyActionInitialization(const wxg4::RunOptions& opts,
+                           const MyDetectorConstruction* detector,
+                           const wxg4::ParticleSource* source);
     ~MyActionInitialization() override = default;
 
     /** Enregistre les actionnaires : primary, run, (event) */
     void Build() const override;
+    /** Multithread : le maître n'a que le RunAction (fusion, profil) */
+    void BuildForMaster() const override;
 
 private:
-    std::string     m_dataset;
-    std::string     m_species;
-    int             m_iteration;
+    /// --calibrate-target : primaires par bin, sorties de la cible enregistrées
+    void BuildCalibration() const;
+
+    const wxg4::RunOptions&       m_opts;
+    const MyDetectorConstruction* m_detector;
+    const wxg4::ParticleSource*   m_source;
 };
 
 #endif // ACTION_HH
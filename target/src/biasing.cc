@@ -0,0 +1,132 @@
+// src/biasing.cc
+#include "biasing.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace wxg4
+{
+
+bool read_bias_spectrum(const std::string& path,
+                        std::vector<BiasBin>& bins,
+                        std::string& err)
+{
+    std::ifstream in(path);
+    if (!in) {
+        err = "cannot open bias spectrum '" + path + "'";
+        return false;
+    }
+
+    bins.clear();
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        ++lineno;
+        const auto hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ls(line);
+        BiasBin b;
+        if (!(ls >> b.Tmin)) continue;  // ligne vide
+        if (!(ls >> b.Tmax >> b.share) || !(b.Tmax > b.Tmin)
+            || !(b.share > 0.0) || b.share > 1.0) {
+            err = path + ":" + std::to_string(lineno)
+                + ": expected 'Tmin Tmax share' with Tmin < Tmax and 0 < share <= 1";
+            return false;
+        }
+        bins.push_back(b);
+    }
+
+    std::sort(bins.begin(), bins.end(),
+              [](const BiasBin& a, const BiasBin& b) { return a.Tmin < b.Tmin; });
+    double total = 0.0;
+    for (std::size_t i = 0; i < bins.size(); ++i) {
+        total += bins[i].share;
+        if (i && bins[i].Tmin < bins[i - 1].Tmax) {
+            err = path + ": overlapping energy bins";
+            return false;
+        }
+    }
+    if (bins.empty() || total > 1.0 + 1e-9) {
+        err = path + ": need at least one bin and shares summing to <= 1";
+        return false;
+    }
+    return true;
+}
+
+void apply_energy_bias(ParticleData& pdata, const std::vector<BiasBin>& bins)
+{
+    // En place : ws[i] est lu avant d'être réécrit
+    apply_energy_bias(ParticleView(pdata), bins, pdata.ws, pdata.wb);
+}
+
+void apply_energy_bias(const ParticleView& pdata, const std::vector<BiasBin>& bins,
+                       std::vector<double>& ws, std::vector<double>& wb)
+{
+    const std::size_t NP = pdata.ws.size();
+    if (bins.empty() || NP == 0) return;
+
+    // Bande de chaque particule (-1 = hors bandes) ; bandes triées et
+    // disjointes, donc Tmax croissants aussi
+    auto bin_of = [&](double T) {
+        auto it = std::lower_bound(bins.begin(), bins.end(), T,
+            [](const BiasBin& b, double t) { return b.Tmax < t; });
+        if (it != bins.end() && T > it->Tmin) {
+            return static_cast<int>(it - bins.begin());
+        }
+        return -1;
+    };
+
+    // Part naturelle (en poids) de chaque bande et du reste
+    const double W = pdata.ws.back();
+    std::vector<int>    which(NP);
+    std::vector<double> natural(bins.size(), 0.0);
+    double outside = 0.0;
+    for (std::size_t i = 0; i < NP; ++i) {
+        const double w = pdata.ws[i] - (i ? pdata.ws[i - 1] : 0.0);
+        which[i] = bin_of(pdata.ek[i]);
+        (which[i] < 0 ? outside : natural[which[i]]) += w / W;
+    }
+
+    // Facteurs d'échantillonnage f = part visée / part naturelle.
+    // Bandes vides ignorées ; sans particule hors bandes, les parts sont
+    // renormalisées pour sommer à 1.
+    double target = 0.0;
+    for (std::size_t b = 0; b < bins.size(); ++b) {
+        if (natural[b] > 0.0) target += bins[b].share;
+    }
+    const double norm = (outside > 0.0) ? 1.0 : 1.0 / target;
+    std::vector<double> factor(bins.size(), 1.0);
+    for (std::size_t b = 0; b < bins.size(); ++b) {
+        if (natural[b] > 0.0) factor[b] = bins[b].share * norm / natural[b];
+        std::cout << "[biasing] T in ]" << bins[b].Tmin << ", " << bins[b].Tmax
+                  << "] MeV : part naturelle " << natural[b]
+                  << " -> " << bins[b].share * norm
+                  << " (facteur " << factor[b] << ")\n";
+    }
+    const double f_out = (outside > 0.0) ? (1.0 - target) / outside : 1.0;
+    std::cout << "[biasing] hors bandes : part naturelle " << outside
+              << " -> " << outside * f_out << " (facteur " << f_out << ")\n";
+    if (outside > 0.0 && !(f_out > 0.0)) {
+        std::cout << "[biasing] ATTENTION : les bandes prennent tous les "
+                     "événements, les particules hors bandes ne seront "
+                     "jamais simulées.\n";
+    }
+
+    // Poids biaisés cumulés et poids compensatoires
+    ws.resize(NP);
+    wb.resize(NP);
+    double prev = 0.0;
+    double wsum = 0.0;
+    for (std::size_t i = 0; i < NP; ++i) {
+        const double w = pdata.ws[i] - prev;
+        prev = pdata.ws[i];
+        const double f = (which[i] < 0) ? f_out : factor[which[i]];
+        wsum += w * f;
+        ws[i] = wsum;
+        wb[i] = (f > 0.0) ? 1.0 / f : 0.0;
+    }
+}
+
+} // namespace wxg4
@@ -0,0 +1,46 @@
+// src/biasing.hh
+#ifndef BIASING_HH
+#define BIASING_HH
+
+#include <string>
+#include <vector>
+
+#include "read.hh"
+
+namespace wxg4
+{
+
+/// Bande d'énergie ]Tmin, Tmax] et part des événements souhaitée
+struct BiasBin {
+    double Tmin, Tmax;  // MeV
+    double share;       // fraction des événements visée, dans ]0, 1]
+};
+
+/**
+ * Lit un spectre cible : une bande par ligne "Tmin Tmax part" (MeV),
+ * lignes vides et commentaires '#' ignorés. Les bandes ne doivent pas se
+ * chevaucher et la somme des parts ne doit pas dépasser 1.
+ * @return false (avec un message dans err) si le fichier est invalide
+ */
+bool read_bias_spectrum(const std::string& path,
+                        std::vector<BiasBin>& bins,
+                        std::string& err);
+
+/**
+ * Échantillonnage préférentiel en énergie. Chaque bande reçoit la part
+ * d'événements demandée ; le reste des événements va aux particules hors
+ * bandes, au prorata de leur poids. ws est remplacé par les poids cumulés
+ * biaisés w_i·f_i et wb[i] = 1/f_i est le poids statistique à porter par
+ * le primaire (et ses hits) pour garder des estimations non biaisées.
+ * Nécessite ek rempli (filter_kinetic_energy).
+ */
+void apply_energy_bias(ParticleData& pdata, const std::vector<BiasBin>& bins);
+
+/// Idem sur des colonnes en lecture seule (cache projeté) : seuls ws
+/// (biaisé) et wb sont écrits, dans des vecteurs à part
+void apply_energy_bias(const ParticleView& pdata, const std::vector<BiasBin>& bins,
+                       std::vector<double>& ws, std::vector<double>& wb);
+
+} // namespace wxg4
+
+#endif // BIASING_HH
@@ -0,0 +1,322 @@
+// src/cache.cc
+#include "cache.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace wxg4
+{
+
+namespace
+{
+
+constexpr char          kMagic[8]  = {'W', 'X', 'G', '4', 'P', 'C', 'H', '\0'};
+constexpr std::uint32_t kVersion   = 2;
+constexpr std::uint64_t kAlign     = 64;
+constexpr std::uint32_t kFlagSorted = 1u;
+
+enum Field { kPx, kPy, kPz, kWs, kEk, kSid, kTable, kFields };
+
+/// Octets par particule de chaque champ
+constexpr std::uint64_t kFieldBytes[kFields] = {
+    sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(double),
+    sizeof(std::uint8_t), sizeof(PrimaryRecord)
+};
+
+struct CacheHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t count;
+    std::uint64_t records;          // enregistrements lus avant filtrage
+    std::uint64_t keyHash;
+    std::uint64_t keyBytes;
+    std::uint64_t offset[kFields];  // octets depuis le début du fichier
+    std::uint64_t fileBytes;
+};
+
+std::uint64_t fnv1a(const std::string& s)
+{
+    std::uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::uint64_t align_up(std::uint64_t x)
+{
+    return (x + kAlign - 1) / kAlign * kAlign;
+}
+
+/// En-tête complet (décalages compris) pour n particules et une clé donnée
+CacheHeader make_header(std::uint64_t n, std::uint64_t records,
+                        const std::string& key, bool sorted)
+{
+    CacheHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version  = kVersion;
+    h.flags    = sorted ? kFlagSorted : 0u;
+    h.count    = n;
+    h.records  = records;
+    h.keyHash  = fnv1a(key);
+    h.keyBytes = key.size();
+
+    std::uint64_t pos = align_up(sizeof(CacheHeader) + key.size());
+    for (int f = 0; f < kFields; ++f) {
+        h.offset[f] = pos;
+        pos = align_up(pos + n * kFieldBytes[f]);
+    }
+    h.fileBytes = pos;
+    return h;
+}
+
+/// Chemin de l'itération : %T ou %0<n>T (série openPMD fichier par
+/// itération) remplacé par son numéro, complété à n chiffres
+std::string expand_iteration(const std::string& dataset, int iteration)
+{
+    const std::size_t pct = dataset.find('%');
+    if (pct == std::string::npos) return dataset;
+    std::size_t i = pct + 1;
+    int width = 0;
+    if (i < dataset.size() && dataset[i] == '0') {
+        ++i;
+        while (i < dataset.size() && dataset[i] >= '0' && dataset[i] <= '9') {
+            width = width * 10 + (dataset[i++] - '0');
+        }
+    }
+    if (i >= dataset.size() || dataset[i] != 'T') return dataset;
+    std::string number = std::to_string(iteration);
+    if (number.size() < static_cast<std::size_t>(width)) {
+        number.insert(0, static_cast<std::size_t>(width) - number.size(), '0');
+    }
+    return dataset.substr(0, pct) + number + dataset.substr(i + 1);
+}
+
+/**
+ * Taille et date de chaque fichier du dataset : le fichier lui-même, ou
+ * tous les fichiers d'un dossier (.bp d'ADIOS2), triés par nom. Faux si
+ * l'un d'eux ne se lit pas : sans empreinte, pas de cache.
+ */
+bool dataset_stamp(const fs::path& path, std::ostringstream& out)
+{
+    std::error_code ec;
+    const fs::file_status st = fs::status(path, ec);
+    if (ec) return false;
+
+    std::vector<fs::path> files;
+    if (fs::is_directory(st)) {
+        fs::recursive_directory_iterator it(path, ec), end;
+        for (; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec)) files.push_back(it->path());
+        }
+        if (ec || files.empty()) return false;
+        std::sort(files.begin(), files.end());
+    } else if (fs::is_regular_file(st)) {
+        files.push_back(path);
+    } else {
+        return false;
+    }
+
+    const fs::path base = files.size() == 1 && files.front() == path ? path.parent_path() : path;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const auto size  = fs::file_size(files[i], ec);
+        if (ec) return false;
+        const auto mtime = fs::last_write_time(files[i], ec);
+        if (ec) return false;
+        out << (i ? "," : "") << files[i].lexically_relative(base).string() << ":" << size
+            << ":" << mtime.time_since_epoch().count();
+    }
+    return true;
+}
+
+} // namespace
+
+std::string particle_cache_key(const std::string& dataset,
+                               const std::vector<SpeciesSpec>& species,
+                               int iteration,
+                               double Tcut_MeV,
+                               SortKey sort,
+                               const Shard& shard)
+{
+    std::error_code ec;
+    const fs::path abs = fs::weakly_canonical(fs::absolute(expand_iteration(dataset, iteration), ec), ec);
+    if (ec) return {};
+
+    std::ostringstream key;
+    key.precision(17);
+    key << "v=" << kVersion
+        << ";dataset=" << abs.string()
+        << ";files=";
+    if (!dataset_stamp(abs, key)) return {};
+    key << ";iteration=" << iteration
+        << ";species=";
+    for (const auto& sp : species) key << sp.name << ":" << sp.g4name << ",";
+    key << ";tcut_MeV=" << Tcut_MeV
+        << ";sort=" << sort_key_name(sort);
+    if (shard.Active()) key << ";shard=" << shard.index << "/" << shard.count;
+    return key.str();
+}
+
+std::string particle_cache_path(const std::string& dir, const std::string& key)
+{
+    char name[64];
+    std::snprintf(name, sizeof name, "wxg4_%016llx.pcache",
+                  static_cast<unsigned long long>(fnv1a(key)));
+    return (fs::path(dir) / name).string();
+}
+
+bool save_particle_cache(const std::string& path,
+                         const std::string& key,
+                         const ParticleData& pdata,
+                         const PrimaryTable& table,
+                         std::uint64_t records,
+                         std::string& err)
+{
+    const std::size_t n = pdata.px.size();
+    if (pdata.py.size() != n || pdata.pz.size() != n || pdata.ws.size() != n
+        || pdata.ek.size() != n || pdata.sid.size() != n) {
+        err = "incomplete particle data (filter not applied?)";
+        return false;
+    }
+    if (table.Size() != n) {
+        err = "primary table does not match the particle data";
+        return false;
+    }
+
+    const CacheHeader h = make_header(n, records, key, pdata.energy_sorted);
+    const void* data[kFields] = {
+        pdata.px.data(), pdata.py.data(), pdata.pz.data(),
+        pdata.ws.data(), pdata.ek.data(), pdata.sid.data(), table.Records()
+    };
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            err = "cannot create " + tmp;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+        for (int f = 0; f < kFields; ++f) {
+            const std::uint64_t bytes = n * kFieldBytes[f];
+            out.seekp(static_cast<std::streamoff>(h.offset[f]));
+            out.write(static_cast<const char*>(data[f]), static_cast<std::streamsize>(bytes));
+        }
+        // Longueur finale (le dernier tableau n'est pas forcément aligné)
+        out.seekp(static_cast<std::streamoff>(h.fileBytes - 1));
+        out.put('\0');
+        if (!out) {
+            err = "write error on " + tmp;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        err = "cannot rename " + tmp + ": " + ec.message();
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+ParticleCacheMap::~ParticleCacheMap()
+{
+    Close();
+}
+
+void ParticleCacheMap::Close()
+{
+    if (fBase) ::munmap(fBase, fBytes);
+    fBase   = nullptr;
+    fBytes  = 0;
+    fCount  = 0;
+    fRecords = 0;
+    fSorted = false;
+    fPx = fPy = fPz = fWs = fEk = nullptr;
+    fSid = nullptr;
+    fTable = nullptr;
+}
+
+bool ParticleCacheMap::Open(const std::string& path, const std::string& key)
+{
+    Close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(CacheHeader)) {
+        ::close(fd);
+        return false;
+    }
+    const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // la projection reste valide
+    if (base == MAP_FAILED) return false;
+
+    // En-tête, clé et taille doivent correspondre exactement
+    const auto* h = static_cast<const CacheHeader*>(base);
+    const char* stored = static_cast<const char*>(base) + sizeof(CacheHeader);
+    const CacheHeader expect = make_header(h->count, h->records, key,
+                                           (h->flags & kFlagSorted) != 0);
+    const bool ok = std::memcmp(h->magic, kMagic, sizeof kMagic) == 0
+                 && h->version == kVersion
+                 && h->keyBytes == key.size()
+                 && h->keyHash == expect.keyHash
+                 && h->fileBytes == bytes
+                 && expect.fileBytes == bytes
+                 && std::memcmp(h->offset, expect.offset, sizeof expect.offset) == 0
+                 && std::memcmp(stored, key.data(), key.size()) == 0;
+    if (!ok) {
+        ::munmap(base, bytes);
+        return false;
+    }
+    ::madvise(base, bytes, MADV_WILLNEED);
+
+    const char* b = static_cast<const char*>(base);
+    fBase   = base;
+    fBytes  = bytes;
+    fCount  = h->count;
+    fRecords = h->records;
+    fSorted = (h->flags & kFlagSorted) != 0;
+    fPx  = reinterpret_cast<const double*>(b + h->offset[kPx]);
+    fPy  = reinterpret_cast<const double*>(b + h->offset[kPy]);
+    fPz  = reinterpret_cast<const double*>(b + h->offset[kPz]);
+    fWs  = reinterpret_cast<const double*>(b + h->offset[kWs]);
+    fEk  = reinterpret_cast<const double*>(b + h->offset[kEk]);
+    fSid = reinterpret_cast<const std::uint8_t*>(b + h->offset[kSid]);
+    fTable = reinterpret_cast<const PrimaryRecord*>(b + h->offset[kTable]);
+    return true;
+}
+
+ParticleView ParticleCacheMap::View() const
+{
+    ParticleView v;
+    v.px  = {fPx, fCount};
+    v.py  = {fPy, fCount};
+    v.pz  = {fPz, fCount};
+    v.ws  = {fWs, fCount};
+    v.sid = {fSid, fCount};
+    v.ek  = {fEk, fCount};
+    v.energy_sorted = fSorted;
+    return v;
+}
+
+} // namespace wxg4
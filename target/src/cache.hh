@@ -0,0 +1,98 @@
+// src/cache.hh
+#ifndef CACHE_HH
+#define CACHE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+#include "reorder.hh"
+#include "primary.hh"
+
+namespace wxg4
+{
+
+/**
+ * Clé du cache de particules : tout ce qui détermine le stockage après
+ * filtrage et tri (chemin absolu de l'itération, %T développé, taille et
+ * date de chacun de ses fichiers, dossier .bp compris, itération,
+ * espèces, coupure, clé de tri, tranche du shard, version du format).
+ * @return chaîne vide si un fichier ne se lit pas : pas de cache
+ */
+std::string particle_cache_key(const std::string& dataset,
+                               const std::vector<SpeciesSpec>& species,
+                               int iteration,
+                               double Tcut_MeV,
+                               SortKey sort,
+                               const Shard& shard = Shard{});
+
+/// Fichier du cache pour cette clé dans dir (nom = hachage de la clé)
+std::string particle_cache_path(const std::string& dir, const std::string& key);
+
+/**
+ * Écrit px, py, pz, ws, ek, sid et les fiches de tirage (sans biais) dans
+ * un fichier plat : en-tête (avec records, nombre d'enregistrements lus
+ * avant filtrage), clé, puis un tableau par champ aligné sur 64 octets.
+ * Écriture dans un fichier temporaire renommé à la fin : un job
+ * concurrent ne voit jamais un cache partiel.
+ * @return false (avec un message dans err) en cas d'échec
+ */
+bool save_particle_cache(const std::string& path,
+                         const std::string& key,
+                         const ParticleData& pdata,
+                         const PrimaryTable& table,
+                         std::uint64_t records,
+                         std::string& err);
+
+/**
+ * Projection mémoire en lecture seule d'un fichier cache. Les tableaux
+ * pointent directement dans les pages du fichier et sont lus en place
+ * pendant le run : plusieurs jobs d'un même nœud partagent une seule
+ * copie des particules, celle du cache de pages.
+ */
+class ParticleCacheMap
+{
+public:
+    ParticleCacheMap() = default;
+    ~ParticleCacheMap();
+    ParticleCacheMap(const ParticleCacheMap&)            = delete;
+    ParticleCacheMap& operator=(const ParticleCacheMap&) = delete;
+
+    /// Projette path ; false si absent, tronqué ou d'une autre clé
+    bool Open(const std::string& path, const std::string& key);
+    void Close();
+
+    std::size_t         size() const { return fCount; }
+    std::uint64_t       records() const { return fRecords; }
+    bool                energy_sorted() const { return fSorted; }
+    const double*       px()  const { return fPx; }
+    const double*       py()  const { return fPy; }
+    const double*       pz()  const { return fPz; }
+    const double*       ws()  const { return fWs; }
+    const double*       ek()  const { return fEk; }
+    const std::uint8_t* sid() const { return fSid; }
+    const PrimaryRecord* table() const { return fTable; }
+
+    /// Colonnes projetées, sans copie (wb vide)
+    ParticleView View() const;
+
+private:
+    void*               fBase   = nullptr;
+    std::size_t         fBytes  = 0;
+    std::size_t         fCount  = 0;
+    std::uint64_t       fRecords = 0;
+    bool                fSorted = false;
+    const double*       fPx  = nullptr;
+    const double*       fPy  = nullptr;
+    const double*       fPz  = nullptr;
+    const double*       fWs  = nullptr;
+    const double*       fEk  = nullptr;
+    const std::uint8_t* fSid = nullptr;
+    const PrimaryRecord* fTable = nullptr;
+};
+
+} // namespace wxg4
+
+#endif // CACHE_HH
@@ -0,0 +1,227 @@
+// src/checkpoint.cc
+#include "checkpoint.hh"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace wxg4
+{
+
+namespace
+{
+
+constexpr std::uint32_t kRecordMagic = 0x56455857;   // "WXEV"
+
+/// En-tête d'un enregistrement, suivi de n x {px, py, pz, w}
+struct RecordHeader {
+    std::uint32_t magic;
+    std::uint32_t n;
+    std::uint64_t event;
+    std::uint32_t checksum;   // FNV-1a de event, n et des hits
+    std::uint32_t pad;
+};
+
+struct RowData {
+    double px, py, pz, w;
+};
+
+std::uint32_t fnv1a(const void* data, std::size_t size, std::uint32_t h = 2166136261u)
+{
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+std::uint32_t record_checksum(const RecordHeader& h, const RowData* rows)
+{
+    std::uint32_t c = fnv1a(&h.event, sizeof h.event);
+    c = fnv1a(&h.n, sizeof h.n, c);
+    return fnv1a(rows, h.n * sizeof(RowData), c);
+}
+
+} // namespace
+
+Checkpoint::Checkpoint(const std::string& dir, const std::string& output)
+: fDir(dir)
+, fStem(fs::path(output).stem().string())
+{}
+
+bool Checkpoint::WriteManifest(const CheckpointManifest& m, std::string& err) const
+{
+    std::error_code ec;
+    fs::create_directories(fDir, ec);
+    const std::string path = (fs::path(fDir) / (fStem + ".manifest")).string();
+    const std::string tmp  = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            err = "cannot create " + tmp;
+            return false;
+        }
+        out << "seed "      << m.seed      << "\n"
+            << "events "    << m.events    << "\n"
+            << "output "    << m.output    << "\n"
+            << "dataset "   << m.dataset   << "\n"
+            << "iteration " << m.iteration << "\n"
+            << "sampler "   << m.sampler   << "\n";
+        if (!out) {
+            err = "write error on " + tmp;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        err = "cannot rename " + tmp + ": " + ec.message();
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool Checkpoint::ReadManifest(CheckpointManifest& m, std::string& err) const
+{
+    const std::string path = (fs::path(fDir) / (fStem + ".manifest")).string();
+    std::ifstream in(path);
+    if (!in) {
+        err = "no checkpoint " + path;
+        return false;
+    }
+    CheckpointManifest r;
+    bool hasSeed = false, hasEvents = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::size_t sp = line.find(' ');
+        if (sp == std::string::npos) continue;
+        const std::string key = line.substr(0, sp), value = line.substr(sp + 1);
+        std::istringstream is(value);
+        if      (key == "seed")      hasSeed = static_cast<bool>(is >> r.seed);
+        else if (key == "events")    hasEvents = static_cast<bool>(is >> r.events);
+        else if (key == "output")    r.output = value;
+        else if (key == "dataset")   r.dataset = value;
+        else if (key == "iteration") is >> r.iteration;
+        else if (key == "sampler")   r.sampler = value;
+    }
+    if (!hasSeed || !hasEvents) {
+        err = "corrupt checkpoint manifest " + path;
+        return false;
+    }
+    m = r;
+    return true;
+}
+
+std::string Checkpoint::JournalPath(unsigned generation, int thread) const
+{
+    return (fs::path(fDir) / (fStem + ".j" + std::to_string(generation) + "."
+                              + std::to_string(thread))).string();
+}
+
+namespace
+{
+
+/// Journaux du run : "<stem>.j<g>.<t>", avec leur numéro de reprise
+std::vector<std::pair<unsigned, fs::path>> list_journals(const std::string& dir,
+                                                         const std::string& stem)
+{
+    std::vector<std::pair<unsigned, fs::path>> out;
+    std::error_code ec;
+    const std::string prefix = stem + ".j";
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) != 0) continue;
+        const std::string rest = name.substr(prefix.size());
+        const std::size_t dot = rest.find('.');
+        if (dot == 0 || dot == std::string::npos
+            || rest.find_first_not_of("0123456789") != dot) continue;
+        out.emplace_back(static_cast<unsigned>(std::stoul(rest.substr(0, dot))), entry.path());
+    }
+    return out;
+}
+
+} // namespace
+
+void Checkpoint::ReadJournals(std::vector<std::uint64_t>& done, std::vector<JournalRow>& rows) const
+{
+    done.clear();
+    rows.clear();
+    std::vector<RowData> buffer;
+    for (const auto& journal : list_journals(fDir, fStem)) {
+        std::ifstream in(journal.second, std::ios::binary);
+        RecordHeader h;
+        while (in.read(reinterpret_cast<char*>(&h), sizeof h)) {
+            if (h.magic != kRecordMagic) break;
+            buffer.resize(h.n);
+            in.read(reinterpret_cast<char*>(buffer.data()),
+                    static_cast<std::streamsize>(h.n * sizeof(RowData)));
+            if (!in || record_checksum(h, buffer.data()) != h.checksum) break;
+            done.push_back(h.event);
+            for (const RowData& r : buffer) rows.push_back({h.event, r.px, r.py, r.pz, r.w});
+        }
+    }
+    std::sort(done.begin(), done.end());
+    done.erase(std::unique(done.begin(), done.end()), done.end());
+}
+
+unsigned Checkpoint::NextGeneration() const
+{
+    unsigned next = 0;
+    for (const auto& journal : list_journals(fDir, fStem)) next = std::max(next, journal.first + 1);
+    return next;
+}
+
+void Checkpoint::Remove() const
+{
+    std::error_code ec;
+    for (const auto& journal : list_journals(fDir, fStem)) fs::remove(journal.second, ec);
+    fs::remove(fs::path(fDir) / (fStem + ".manifest"), ec);
+}
+
+bool CheckpointJournal::Open(const std::string& path)
+{
+    Close();
+    std::error_code ec;
+    const fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+    fFile = std::fopen(path.c_str(), "ab");
+    return fFile != nullptr;
+}
+
+void CheckpointJournal::Append(std::uint64_t event, const JournalRow* rows, std::uint32_t n)
+{
+    if (!fFile) return;
+    thread_local std::vector<RowData> buffer;
+    buffer.resize(n);
+    for (std::uint32_t i = 0; i < n; ++i) buffer[i] = {rows[i].px, rows[i].py, rows[i].pz, rows[i].w};
+
+    RecordHeader h{kRecordMagic, n, event, 0, 0};
+    h.checksum = record_checksum(h, buffer.data());
+    std::fwrite(&h, sizeof h, 1, fFile);
+    if (n) std::fwrite(buffer.data(), sizeof(RowData), n, fFile);
+}
+
+void CheckpointJournal::Sync()
+{
+    if (!fFile) return;
+    std::fflush(fFile);
+    ::fsync(::fileno(fFile));
+}
+
+void CheckpointJournal::Close()
+{
+    if (!fFile) return;
+    Sync();
+    std::fclose(fFile);
+    fFile = nullptr;
+}
+
+} // namespace wxg4
@@ -0,0 +1,94 @@
+// src/checkpoint.hh
+#ifndef CHECKPOINT_HH
+#define CHECKPOINT_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace wxg4
+{
+
+/**
+ * Points de reprise d'un run (--checkpoint <dossier>). Chaque thread
+ * tient un journal des événements terminés : numéro d'événement du run
+ * complet et hits de l'événement, synchronisé sur disque tous les N
+ * événements. Les graines étant fixées par événement, un run repris
+ * rejoue les hits des journaux puis simule les seuls événements absents :
+ * le résultat final est celui d'un run sans interruption.
+ *
+ * Fichiers d'un run (output = "output_t2mm.root") :
+ *   <dossier>/output_t2mm.manifest      paramètres du run, à vérifier à la reprise
+ *   <dossier>/output_t2mm.j<g>.<t>      journal du thread t, reprise numéro g
+ */
+struct CheckpointManifest {
+    std::uint64_t seed   = 0;    // graine de base (--seed), par événement ensuite
+    std::uint64_t events = 0;    // événements du run complet
+    std::string   output;        // fichier de hits du run
+    std::string   dataset;
+    int           iteration = 0;
+    std::string   sampler;
+};
+
+/// Hit journalisé : une ligne du ntuple "momenta"
+struct JournalRow {
+    std::uint64_t event;
+    double        px, py, pz, w;
+};
+
+class Checkpoint
+{
+public:
+    /// output : fichier de hits du run (suffixes de shard et de run inclus)
+    Checkpoint(const std::string& dir, const std::string& output);
+
+    bool WriteManifest(const CheckpointManifest& manifest, std::string& err) const;
+    /// false si absent (pas de reprise possible) ou illisible
+    bool ReadManifest(CheckpointManifest& manifest, std::string& err) const;
+
+    /**
+     * Relit tous les journaux : événements terminés (triés) et leurs hits.
+     * Un enregistrement tronqué ou corrompu (fin de journal au moment de
+     * l'arrêt) est ignoré avec tout ce qui le suit.
+     */
+    void ReadJournals(std::vector<std::uint64_t>& done, std::vector<JournalRow>& rows) const;
+    /// Numéro de la prochaine reprise (0 sans journal)
+    unsigned NextGeneration() const;
+    /// Chemin du journal du thread `thread` pour la reprise `generation`
+    std::string JournalPath(unsigned generation, int thread) const;
+    /// Manifeste et journaux supprimés (fin normale du run)
+    void Remove() const;
+
+private:
+    std::string fDir;
+    std::string fStem;    // nom de la sortie sans ".root"
+};
+
+/**
+ * Journal d'un thread : un enregistrement par événement terminé, en
+ * ajout seul. Sync() (fflush + fsync) marque le point de reprise ; ce qui
+ * suit le dernier Sync() peut être perdu à l'arrêt, jamais mal relu.
+ */
+class CheckpointJournal
+{
+public:
+    CheckpointJournal() = default;
+    ~CheckpointJournal() { Close(); }
+    CheckpointJournal(const CheckpointJournal&)            = delete;
+    CheckpointJournal& operator=(const CheckpointJournal&) = delete;
+
+    bool Open(const std::string& path);
+    bool IsOpen() const { return fFile != nullptr; }
+    /// Événement terminé et ses hits (rows[i].event = event)
+    void Append(std::uint64_t event, const JournalRow* rows, std::uint32_t n);
+    void Sync();
+    void Close();
+
+private:
+    std::FILE* fFile = nullptr;
+};
+
+} // namespace wxg4
+
+#endif // CHECKPOINT_HH
@@ -0,0 +1,169 @@
+// src/compare.cc
+#include "compare.hh"
+
+#include <G4RootAnalysisReader.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+namespace wxg4
+{
+
+namespace
+{
+
+constexpr double kRadToDeg = 57.29577951308232;
+
+/// Moyenne par événement d'un bin et variance de cette moyenne, tirées
+/// des moyennes des lots
+struct BinEstimate { double mean, var; };
+
+BinEstimate estimate_bin(const std::vector<Hist1D>& batches,
+                         const std::vector<double>& batchEvents,
+                         std::uint64_t events, unsigned bin)
+{
+    double sum = 0.;
+    unsigned used = 0;
+    double meanOfBatches = 0.;
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        sum += batches[b].weight[bin];
+        if (batchEvents[b] > 0.) {
+            meanOfBatches += batches[b].weight[bin] / batchEvents[b];
+            ++used;
+        }
+    }
+    const double mean = events ? sum / static_cast<double>(events) : 0.;
+    if (used < 2) return {mean, 0.};
+    meanOfBatches /= used;
+    double ss = 0.;
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        if (batchEvents[b] <= 0.) continue;
+        const double d = batches[b].weight[bin] / batchEvents[b] - meanOfBatches;
+        ss += d * d;
+    }
+    return {mean, ss / (used - 1) / used};
+}
+
+SpectrumDiff compare_spectrum(const char* name, const char* unit,
+                              const std::vector<Hist1D>& a, const HitSample& sa,
+                              const std::vector<Hist1D>& b, const HitSample& sb)
+{
+    SpectrumDiff d;
+    d.name = name;
+    d.unit = unit;
+    if (a.empty() || b.empty()) return d;
+    const HistAxis& axis = a.front().axis;
+    for (unsigned k = 0; k < axis.N(); ++k) {
+        const BinEstimate ea = estimate_bin(a, sa.batchEvents, sa.events, k);
+        const BinEstimate eb = estimate_bin(b, sb.batchEvents, sb.events, k);
+        const double var = ea.var + eb.var;
+        if (var <= 0.) continue;
+        const double pull = (eb.mean - ea.mean) / std::sqrt(var);
+        d.chi2 += pull * pull;
+        ++d.ndf;
+        if (std::fabs(pull) > std::fabs(d.maxPull)) {
+            d.maxPull = pull;
+            d.lo = axis.Edge(k);
+            d.hi = axis.Edge(k + 1);
+        }
+    }
+    return d;
+}
+
+} // namespace
+
+bool read_hit_sample(const std::string& path, std::uint64_t events,
+                     const CompareConfig& cfg, HitSample& sample, std::string& err)
+{
+    auto* reader = G4RootAnalysisReader::Instance();
+    reader->SetVerboseLevel(0);
+    const G4int id = reader->GetNtuple("momenta", path);
+    if (id < 0) {
+        err = "no 'momenta' ntuple in " + path;
+        return false;
+    }
+    G4int    eventID = 0;
+    G4double px = 0., py = 0., pz = 0., w = 0.;
+    reader->SetNtupleIColumn(id, "eventID", eventID);
+    reader->SetNtupleDColumn(id, "px", px);
+    reader->SetNtupleDColumn(id, "py", py);
+    reader->SetNtupleDColumn(id, "pz", pz);
+    reader->SetNtupleDColumn(id, "weight", w);
+
+    const unsigned nb = std::max(cfg.batches, 1u);
+    const HistAxis energy(cfg.energy, true), theta(cfg.theta, false);
+    sample = HitSample{};
+    sample.p.assign(nb, Hist1D(energy));
+    sample.T.assign(nb, Hist1D(energy));
+    sample.theta.assign(nb, Hist1D(theta));
+
+    std::vector<std::uint32_t> perEvent(events, 0);
+    while (reader->GetNtupleRow(id)) {
+        if (eventID < 0) continue;
+        const auto ev = static_cast<std::uint64_t>(eventID);
+        if (ev >= perEvent.size()) perEvent.resize(ev + 1, 0);
+        ++perEvent[ev];
+        ++sample.hits;
+
+        const unsigned b = static_cast<unsigned>(ev % nb);
+        const double p = std::sqrt(px * px + py * py + pz * pz);
+        const double T = std::sqrt(p * p + cfg.mass * cfg.mass) - cfg.mass;
+        const double th = p > 0. ? std::acos(std::clamp(pz / p, -1., 1.)) * kRadToDeg : 0.;
+        sample.p[b].Fill(p, w);
+        sample.T[b].Fill(T, w);
+        sample.theta[b].Fill(th, w);
+    }
+
+    // Événements sans hit compris : ils pèsent sur la moyenne et la dispersion
+    sample.events = perEvent.size();
+    sample.batchEvents.assign(nb, 0.);
+    double sum = 0., sum2 = 0.;
+    for (std::uint64_t ev = 0; ev < perEvent.size(); ++ev) {
+        const double n = perEvent[ev];
+        sum  += n;
+        sum2 += n * n;
+        sample.batchEvents[ev % nb] += 1.;
+    }
+    if (sample.events) {
+        const double ne = static_cast<double>(sample.events);
+        sample.perEventMean = sum / ne;
+        sample.perEventVar  = sample.events > 1
+            ? std::max(0., (sum2 - sum * sum / ne) / (ne - 1.)) : 0.;
+    }
+    return true;
+}
+
+SampleDiff compare_hit_samples(const HitSample& a, const HitSample& b)
+{
+    SampleDiff d;
+    d.meanA = a.perEventMean;
+    d.meanB = b.perEventMean;
+    d.errA  = a.events ? std::sqrt(a.perEventVar / static_cast<double>(a.events)) : 0.;
+    d.errB  = b.events ? std::sqrt(b.perEventVar / static_cast<double>(b.events)) : 0.;
+    const double sigma = std::sqrt(d.errA * d.errA + d.errB * d.errB);
+    d.pull = sigma > 0. ? (d.meanB - d.meanA) / sigma : 0.;
+
+    d.spectra.push_back(compare_spectrum("p", "MeV/c", a.p, a, b.p, b));
+    d.spectra.push_back(compare_spectrum("T", "MeV", a.T, a, b.T, b));
+    d.spectra.push_back(compare_spectrum("theta", "deg", a.theta, a, b.theta, b));
+    return d;
+}
+
+void print_sample_diff(std::ostream& os, const std::string& prefix,
+                       const std::string& labelA, const std::string& labelB,
+                       const SampleDiff& diff)
+{
+    os << prefix << "hits/évt " << labelA << " " << diff.meanA << " ± " << diff.errA
+       << " | " << labelB << " " << diff.meanB << " ± " << diff.errB
+       << " | écart " << diff.pull << " sigma\n";
+    for (const auto& s : diff.spectra) {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-5s chi2/ndf = %.1f/%u, pull max %+.2f (%g-%g %s)",
+                      s.name.c_str(), s.chi2, s.ndf, s.maxPull, s.lo, s.hi, s.unit.c_str());
+        os << prefix << "spectre " << line << "\n";
+    }
+}
+
+} // namespace wxg4
@@ -0,0 +1,75 @@
+// src/compare.hh
+#ifndef COMPARE_HH
+#define COMPARE_HH
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "histogram.hh"
+
+namespace wxg4
+{
+
+/// Axes et lots de la comparaison de deux sorties
+struct CompareConfig {
+    double   mass    = 0.51099895;       // MeV, masse supposée des hits pour T
+    BinSpec  energy{0.1, 1e5, 60};       // p [MeV/c] et T [MeV], log
+    BinSpec  theta{0., 90., 45};         // deg / +z
+    unsigned batches = 50;               // lots d'événements (eventID % lots)
+};
+
+/**
+ * Hits d'une sortie (ntuple "momenta") rangés par événement. Les hits
+ * d'un événement viennent de la même gerbe et sont fortement corrélés :
+ * les erreurs se déduisent de la dispersion des hits par événement, et
+ * pour les spectres de la dispersion entre lots d'événements (chaque
+ * événement entier dans un lot), jamais d'un Poisson sur les hits.
+ */
+struct HitSample {
+    std::uint64_t       events = 0;      // événements simulés, sans hit compris
+    std::uint64_t       hits   = 0;
+    double              perEventMean = 0.;
+    double              perEventVar  = 0.;
+    std::vector<double> batchEvents;     // événements par lot
+    std::vector<Hist1D> p, T, theta;     // un histogramme pondéré par lot
+};
+
+/**
+ * Lit path dans sample. events : nombre d'événements du run (ceux sans
+ * hit n'apparaissent pas dans le ntuple) ; 0 = déduit du plus grand
+ * eventID, ce qui ignore les derniers événements sans hit.
+ * @return false (avec un message dans err) si le ntuple est illisible
+ */
+bool read_hit_sample(const std::string& path, std::uint64_t events,
+                     const CompareConfig& cfg, HitSample& sample, std::string& err);
+
+/// Écart entre deux spectres, normalisés par événement
+struct SpectrumDiff {
+    std::string name;
+    std::string unit;
+    double      chi2    = 0.;
+    unsigned    ndf     = 0;       // bins non vides dans au moins une sortie
+    double      maxPull = 0.;      // plus grand |écart| / sigma d'un bin
+    double      lo = 0., hi = 0.;  // bornes de ce bin
+};
+
+struct SampleDiff {
+    double meanA = 0., errA = 0.;  // hits par événement et erreur sur la moyenne
+    double meanB = 0., errB = 0.;
+    double pull  = 0.;             // (B - A) / sigma
+    std::vector<SpectrumDiff> spectra;   // p, T, theta
+};
+
+/// a et b doivent avoir été lus avec la même configuration
+SampleDiff compare_hit_samples(const HitSample& a, const HitSample& b);
+
+/// Rapport lisible, une ligne par grandeur, préfixée par prefix
+void print_sample_diff(std::ostream& os, const std::string& prefix,
+                       const std::string& labelA, const std::string& labelB,
+                       const SampleDiff& diff);
+
+} // namespace wxg4
+
+#endif // COMPARE_HH
@@ -9,17 +9,26 @@
 #include <G4SDManager.hh>
 #include <G4VisAttributes.hh>
 #include <G4Colour.hh>
+#include <G4Region.hh>
+#include <G4ProductionCuts.hh>
 
+#include "profiler.hh"
+#include "fastsim.hh"
 #include "detector.hh" // ton MySensitiveDetector (déclare une classe dérivée de G4VSensitiveDetector)
 
-MyDetectorConstruction::MyDetectorConstruction(double thickness)
+MyDetectorConstruction::MyDetectorConstruction(double thickness,
+                                               double cutTarget,
+                                               double cutDetector)
 : m_thickness(thickness)
+, m_cutTarget(cutTarget)
+, m_cutDetector(cutDetector)
 {}
 
 MyDetectorConstruction::~MyDetectorConstruction() = default;
 
 G4VPhysicalVolume* MyDetectorConstruction::Construct()
 {
+    wxg4::ScopeTimer timer(wxg4::Stage::Geometry);
     auto* nist = G4NistManager::Instance();
 
     // Matériaux
@@ -28,20 +37,21 @@ G4VPhysicalVolume* MyDetectorConstruction::Construct()
     G4Material* pixelMat   = nist->FindOrBuildMaterial("G4_Si");       // silicium
 
     // Monde : boîte de demi-longueurs 1 m -> volume total 2m x 2m x 2m
-    auto* solidWorld  = new G4Box("solidWorld", 1.0*m, 1.0*m, 1.0*m);
+    auto* solidWorld  = new G4Box("solidWorld", kWorldHalf, kWorldHalf, kWorldHalf);
     auto* logicWorld  = new G4LogicalVolume(solidWorld, worldMat, "logicWorld");
     auto* physWorld   = new G4PVPlacement(nullptr, {}, logicWorld, "physWorld", nullptr, false, 0, true);
 
     // Cible : 1m x 1m en XY, épaisseur physique m_thickness
-    const G4double halfX = 0.5*m;
-    const G4double halfY = 0.5*m;
+    const G4double halfX = kTargetHalfXY;
+    const G4double halfY = kTargetHalfXY;
     const G4double halfZ = 0.5*m_thickness; // ATTENTION: semi-longueur
 
-    auto* solidTarget = new G4Box("solidTarget", halfX, halfY, halfZ);
-    auto* logicTarget = new G4LogicalVolume(solidTarget, targetMat, "logicTarget");
+    m_solidTarget = new G4Box("solidTarget", halfX, halfY, halfZ);
+    auto* logicTarget = new G4LogicalVolume(m_solidTarget, targetMat, "logicTarget");
+    m_logicTarget = logicTarget;
 
     // Position cible au centre z = 0.60 m
-    const G4double Target_Zpos = 0.60*m;
+    const G4double Target_Zpos = kTargetZ;
     new G4PVPlacement(
         nullptr,
         G4ThreeVector(0., 0., Target_Zpos),
@@ -54,11 +64,11 @@ G4VPhysicalVolume* MyDetectorConstruction::Construct()
     );
 
     // Détecteur plan pixellisé, à z = 0.99 m
-    const G4double Detector_Zpos = 0.99*m;
+    const G4double Detector_Zpos = kDetectorZ;
 
     // Un pixel : demi-dimensions 5 mm x 5 mm x 5 mm (cube 1 cm^3)
-    const G4double pixHalfXY = 5.0*mm;
-    const G4double pixHalfZ  = 5.0*mm;
+    const G4double pixHalfXY = kPixelHalf;
+    const G4double pixHalfZ  = kPixelHalf;
 
     auto* solidPixel = new G4Box("solidDetectorPixel", pixHalfXY, pixHalfXY, pixHalfZ);
     m_logicDetectorPixel = new G4LogicalVolume(solidPixel, pixelMat, "logicDetectorPixel");
@@ -66,8 +76,8 @@ G4VPhysicalVolume* MyDetectorConstruction::Construct()
     // Tapis de pixels couvrant [-1m, +1m] en X et Y
     const G4int nX = 200;
     const G4int nY = 200;
-    const G4double widthX = 2.0*m;
-    const G4double widthY = 2.0*m;
+    const G4double widthX = 2.0*kWorldHalf;
+    const G4double widthY = 2.0*kWorldHalf;
     const G4double stepX  = widthX / nX;
     const G4double stepY  = widthY / nY;
 
@@ -76,8 +86,8 @@ G4VPhysicalVolume* MyDetectorConstruction::Construct()
     {
         for (G4int j = 0; j < nY; ++j)
         {
-            const G4double xPos = -1.0*m + (i + 0.5)*stepX;
-            const G4double yPos = -1.0*m + (j + 0.5)*stepY;
+            const G4double xPos = -kWorldHalf + (i + 0.5)*stepX;
+            const G4double yPos = -kWorldHalf + (j + 0.5)*stepY;
 
             new G4PVPlacement(
                 nullptr,
@@ -92,6 +102,20 @@ G4VPhysicalVolume* MyDetectorConstruction::Construct()
         }
     }
 
+    // Régions : coupures de production propres à la cible et aux pixels
+    // (dans les pixels, on ne s'intéresse qu'aux particules qui arrivent)
+    m_targetCuts = new G4ProductionCuts();
+    m_targetCuts->SetProductionCut(m_cutTarget);
+    m_targetRegion = new G4Region("TargetRegion");
+    m_targetRegion->AddRootLogicalVolume(logicTarget);
+    m_targetRegion->SetProductionCuts(m_targetCuts);
+
+    m_detectorCuts = new G4ProductionCuts();
+    m_detectorCuts->SetProductionCut(m_cutDetector);
+    auto* detectorRegion = new G4Region("DetectorRegion");
+    detectorRegion->AddRootLogicalVolume(m_logicDetectorPixel);
+    detectorRegion->SetProductionCuts(m_detectorCuts);
+
     // (Optionnel) un peu de couleur pour le visu
     logicWorld->SetVisAttributes(G4VisAttributes::GetInvisible());
 
@@ -106,6 +130,31 @@ G4VPhysicalVolume* MyDetectorConstruction::Construct()
     return physWorld;
 }
 
+bool MyDetectorConstruction::SetThickness(double thickness)
+{
+    // Face avant de la cible en deçà du plan de pixels
+    if (thickness <= 0. || kTargetZ + 0.5*thickness >= kDetectorZ - kPixelHalf) {
+        G4ExceptionDescription desc;
+        desc << "Épaisseur " << thickness / mm << " mm hors limites (0, "
+             << 2.0*(kDetectorZ - kPixelHalf - kTargetZ) / mm << ") mm.";
+        G4Exception("MyDetectorConstruction", "BadThickness", JustWarning, desc);
+        return false;
+    }
+    m_thickness = thickness;
+    if (m_solidTarget) m_solidTarget->SetZHalfLength(0.5*thickness);
+    return true;
+}
+
+void MyDetectorConstruction::SetRegionCuts(double cutTarget, double cutDetector)
+{
+    m_cutTarget   = cutTarget;
+    m_cutDetector = cutDetector;
+    // Géométrie déjà construite : Geant4 voit la modification et refait
+    // la table des couples matériau-coupure au début du run suivant
+    if (m_targetCuts)   m_targetCuts->SetProductionCut(cutTarget);
+    if (m_detectorCuts) m_detectorCuts->SetProductionCut(cutDetector);
+}
+
 void MyDetectorConstruction::ConstructSDandField()
 {
     // Crée et enregistre le détecteur sensible
@@ -115,4 +164,9 @@ void MyDetectorConstruction::ConstructSDandField()
 
     // Attache le SD à la logique des pixels
     m_logicDetectorPixel->SetSensitiveDetector(sd);
+
+    // Transport rapide de la cible (enregistré auprès de la région)
+    if (m_kernel) {
+        new MyTargetFastModel("TargetTransmission", m_targetRegion, m_kernel, this);
+    }
 }
\ No newline at end of file
@@ -3,19 +3,67 @@
 
 #include <G4VUserDetectorConstruction.hh>
 #include <G4LogicalVolume.hh>
+#include <G4SystemOfUnits.hh>
+
+class G4Box;
+class G4ProductionCuts;
+class G4Region;
+namespace wxg4 { class TransmissionKernel; }
 
 class MyDetectorConstruction : public G4VUserDetectorConstruction
 {
 public:
     // thickness = épaisseur physique de la cible en mètres
-    explicit MyDetectorConstruction(double thickness);
+    // cutTarget / cutDetector = coupures de production des régions
+    // "TargetRegion" et "DetectorRegion" (le monde garde celle de la liste physique)
+    explicit MyDetectorConstruction(double thickness,
+                                    double cutTarget   = 0.7*mm,
+                                    double cutDetector = 0.7*mm);
     ~MyDetectorConstruction() override;
 
     G4VPhysicalVolume* Construct() override;
     void ConstructSDandField() override;
 
+    /**
+     * Change l'épaisseur de la cible entre deux runs (balayage) : seule la
+     * demi-longueur du solide est modifiée, pixels et physique restent en
+     * place. L'appelant signale ensuite G4RunManager::GeometryHasBeenModified().
+     * @return false si la cible ne tiendrait plus devant les pixels
+     */
+    bool SetThickness(double thickness);
+    double GetThickness() const { return m_thickness; }
+
+    /// Coupures des régions cible et pixels ; appliquées au prochain run
+    void SetRegionCuts(double cutTarget, double cutDetector);
+
+    /**
+     * Noyaux de transmission (--fast-target) : MyTargetFastModel est
+     * attaché à "TargetRegion" dans ConstructSDandField (un par thread).
+     * À fixer avant l'initialisation ; nullptr = transport détaillé.
+     */
+    void SetTransmissionKernel(const wxg4::TransmissionKernel* kernel) { m_kernel = kernel; }
+
+    /// Volume logique de la cible (calibration des noyaux)
+    const G4LogicalVolume* GetTargetVolume() const { return m_logicTarget; }
+
+    // Géométrie, partagée avec les actions utilisateur (unités Geant4)
+    static constexpr G4double kWorldHalf    = 1.0*m;   // monde 2m x 2m x 2m
+    static constexpr G4double kTargetHalfXY = 0.5*m;   // cible 1m x 1m en XY
+    static constexpr G4double kTargetZ      = 0.60*m;  // centre de la cible
+    static constexpr G4double kDetectorZ    = 0.99*m;  // centre du plan de pixels
+    static constexpr G4double kPixelHalf    = 5.0*mm;  // pixel = cube de 1 cm
+
 private:
     double m_thickness; // épaisseur physique [m]
+    double m_cutTarget;
+    double m_cutDetector;
+
+    G4Box* m_solidTarget = nullptr;
+    G4LogicalVolume* m_logicTarget = nullptr;
+    G4Region* m_targetRegion = nullptr;
+    const wxg4::TransmissionKernel* m_kernel = nullptr;
+    G4ProductionCuts* m_targetCuts   = nullptr;
+    G4ProductionCuts* m_detectorCuts = nullptr;
 
     // On garde un pointeur vers le LV des pixels pour lui attacher le SD
     G4LogicalVolume* m_logicDetectorPixel = nullptr;
@@ -0,0 +1,444 @@
+// src/controller.cc
+#include "controller.hh"
+
+#include <G4RunManager.hh>
+#include <G4StateManager.hh>
+#include <G4Threading.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4ios.hh>
+#include <Randomize.hh>
+
+#include <openPMD/openPMD.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+#include "checkpoint.hh"
+#include "construction.hh"
+#include "profiler.hh"
+#include "run.hh"
+
+MyRunController::MyRunController(wxg4::RunOptions& opts,
+                                 G4RunManager* runManager,
+                                 MyDetectorConstruction* detector,
+                                 wxg4::ParticleSource* source)
+: fOpts(opts)
+, fRunManager(runManager)
+, fDetector(detector)
+, fSource(source)
+{}
+
+MyRunController::~MyRunController() = default;
+
+void MyRunController::SetDataset(const std::string& path)
+{
+    fOpts.dataset = path;
+    fSeries.reset();
+    fDataDirty = true;
+}
+
+bool MyRunController::SetSpecies(const std::string& list)
+{
+    auto species = wxg4::parse_species_list(list);
+    if (species.empty()) return false;
+    fOpts.species = species;
+    fDataDirty = true;
+    return true;
+}
+
+void MyRunController::SetIteration(int iteration)
+{
+    fOpts.iteration = iteration;
+    fDataDirty = true;
+}
+
+bool MyRunController::SetFraction(double pct)
+{
+    if (pct <= 0.) return false;
+    fOpts.fraction_pct = pct;
+    // Réservoir : la taille de l'échantillon est fixée à la lecture
+    if (fOpts.sampler == wxg4::Sampler::Reservoir) fDataDirty = true;
+    return true;
+}
+
+bool MyRunController::SetSampler(wxg4::Sampler sampler)
+{
+    // Le réservoir porte déjà ses poids (Horvitz–Thompson dans wb)
+    if (sampler == wxg4::Sampler::Reservoir && !fOpts.biasFile.empty()) {
+        G4cerr << "[wxg4] sampler : reservoir incompatible avec --bias "
+                  "(relancer sans --bias)\n";
+        return false;
+    }
+    // Passage vers ou depuis le réservoir : données à relire
+    if ((sampler == wxg4::Sampler::Reservoir) != (fOpts.sampler == wxg4::Sampler::Reservoir)) {
+        fDataDirty = true;
+    }
+    fOpts.sampler = sampler;
+    return true;
+}
+
+bool MyRunController::SetThickness(G4double thickness)
+{
+    if (!fDetector->SetThickness(thickness)) return false;
+    fOpts.thickness_mm = thickness / mm;
+    // Avant l'initialisation, Construct() lira directement la nouvelle valeur
+    if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_PreInit) {
+        fRunManager->GeometryHasBeenModified();
+    }
+    return true;
+}
+
+bool MyRunController::SetRegionCuts(G4double cutTarget, G4double cutDetector)
+{
+    if (cutTarget <= 0. || cutDetector <= 0.) return false;
+    fDetector->SetRegionCuts(cutTarget, cutDetector);
+    fOpts.cutTarget_mm   = cutTarget / mm;
+    fOpts.cutDetector_mm = cutDetector / mm;
+    return true;
+}
+
+void MyRunController::SetOutput(const std::string& name)
+{
+    std::string base = name;
+    const std::string ext = ".root";
+    if (base.size() > ext.size()
+        && base.compare(base.size() - ext.size(), ext.size(), ext) == 0) {
+        base.erase(base.size() - ext.size());
+    }
+    MyRunAction::SetOutputBase(base + wxg4::shard_suffix(fOpts.shard));
+}
+
+bool MyRunController::SetThreads(int n)
+{
+    if (n < 1) return false;
+    if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_PreInit) {
+        G4cerr << "[wxg4] threads : à régler avant /run/initialize\n";
+        return false;
+    }
+    if (!G4Threading::IsMultithreadedApplication()) {
+        G4cerr << "[wxg4] threads : gestionnaire séquentiel "
+                  "(relancer avec --threads N)\n";
+        return false;
+    }
+    fOpts.threads = n;
+    fRunManager->SetNumberOfThreads(n);
+    return true;
+}
+
+void MyRunController::SetMpi(const wxg4::MpiSession* mpi, const std::string& profile)
+{
+    fMpi = mpi;
+    fMpiProfile = profile;
+}
+
+bool MyRunController::LoadData()
+{
+    if (fOpts.dataset.empty() || fOpts.species.empty()) {
+        G4cerr << "[wxg4] dataset et espèces requis (/wxg4/dataset, /wxg4/species)\n";
+        return false;
+    }
+
+    // Cache préfiltré consulté avant toute ouverture de la série : le
+    // nombre de particules lues est dans son en-tête. MPI : la série est
+    // ouverte collectivement, on ne s'en passe que si tous les rangs ont
+    // leur cache.
+    const bool cached = fSource->LoadCached(fOpts);
+    const bool mpi = fMpi && fMpi->Active();
+    const bool allCached = mpi
+        ? fMpi->Sum(static_cast<std::uint64_t>(cached)) == static_cast<std::uint64_t>(fMpi->Size())
+        : cached;
+    if (allCached) {
+        fParticles = fSource->Records();
+        fDataDirty = false;
+        return true;
+    }
+
+    // Série ouverte une seule fois par dataset : sert au comptage ici puis
+    // à la lecture des impulsions. Analyse différée : seules les
+    // métadonnées de l'itération demandée sont lues.
+    try {
+        if (!fSeries) {
+#ifdef WXG4_USE_MPI
+            // Ouverture collective : chaque rang lit ensuite sa tranche
+            if (fMpi && fMpi->Active()) {
+                fSeries = std::make_unique<openPMD::Series>(
+                    fOpts.dataset, openPMD::Access::READ_ONLY, fMpi->Comm(),
+                    wxg4::OPENPMD_READ_OPTIONS);
+            }
+#endif
+            if (!fSeries) {
+                fSeries = std::make_unique<openPMD::Series>(
+                    fOpts.dataset, openPMD::Access::READ_ONLY, wxg4::OPENPMD_READ_OPTIONS);
+            }
+        }
+        if (fSeries->iterations.count(fOpts.iteration) == 0) {
+            G4cerr << "Iteration " << fOpts.iteration << " not found in series!\n";
+            return false;
+        }
+        auto it = fSeries->iterations[fOpts.iteration];
+        it.open();
+
+        fParticles = 0;
+        for (const auto& sp : fOpts.species) {
+            if (it.particles.count(sp.name) == 0) {
+                G4cerr << "Species '" << sp.name << "' not found!\n";
+                return false;
+            }
+            auto& px = it.particles[sp.name]["momentum"]["x"];
+            std::uint64_t first = 0, n = px.getExtent()[0];
+            if (fOpts.shard.Active()) wxg4::shard_range(px.getExtent()[0], fOpts.shard, first, n);
+            fParticles += n;
+        }
+    } catch (const std::exception& e) {
+        G4cerr << "[wxg4] openPMD : " << e.what() << "\n";
+        fSeries.reset();
+        return false;
+    }
+
+    if (!cached && !fSource->Load(fOpts, fSeries.get())) return false;
+    fDataDirty = false;
+    return true;
+}
+
+bool MyRunController::Prepare(std::uint64_t nEvents)
+{
+    if (fDataDirty && !LoadData()) return false;
+
+    if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_PreInit) {
+        wxg4::ScopeTimer timer(wxg4::Stage::Initialize);
+        fRunManager->Initialize();
+    }
+
+    // MPI : fraction et nombre d'événements rapportés à toutes les tranches
+    const bool mpi = fMpi && fMpi->Active();
+    const std::uint64_t particles = mpi ? fMpi->Sum(fParticles) : fParticles;
+    if (nEvents == 0) {
+        const double fraction = fOpts.fraction_pct / 100.0;
+        nEvents = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(particles)));
+        if (nEvents == 0) nEvents = 1;
+        if (nEvents > particles) nEvents = particles;
+    }
+    if (mpi) {
+        const std::uint64_t total = nEvents;
+        nEvents = ShareEvents(total);
+        G4cout << "[mpi] rang " << fMpi->Rank() << "/" << fMpi->Size() << " : "
+               << nEvents << " / " << total << " événements" << G4endl;
+    }
+    fOpts.nEvents = nEvents;
+
+    G4cout << "[openPMD] particles=" << fParticles
+           << " | fraction=" << fOpts.fraction_pct << "% -> nEvents=" << nEvents
+           << " | sampler=" << wxg4::sampler_name(fOpts.sampler) << G4endl;
+    fSource->PrepareRun(nEvents, fOpts.sampler);
+    return true;
+}
+
+bool MyRunController::BeamOn(std::uint64_t nEvents)
+{
+    if (!Prepare(nEvents)) return false;
+    std::uint64_t events = fOpts.nEvents;
+    const bool checkpoint = !fOpts.checkpointDir.empty();
+    if (checkpoint && !PrepareCheckpoint(events)) return false;
+    if (!checkpoint || events > 0) {
+        G4cout << "[batch] Calling BeamOn(" << events << ") -> "
+               << MyRunAction::OutputFile() << ".\n";
+        fRunManager->BeamOn(static_cast<G4int>(events));
+        MyRunAction::SetResume({}, {});
+    }
+    if (fOpts.shard.Active()) WriteShardSummary();
+    if (fMpi && fMpi->Active()) ReduceProfile();
+    return true;
+}
+
+long MyRunController::StreamRuns()
+{
+    long runs = 0;
+    try {
+        fSeries = std::make_unique<openPMD::Series>(
+            fOpts.dataset, openPMD::Access::READ_ONLY, wxg4::OPENPMD_READ_OPTIONS);
+        G4cout << "[stream] " << fOpts.dataset << " : attente des itérations (backend "
+               << fSeries->backend() << ")" << G4endl;
+
+        // Accès linéaire : chaque itération n'est visible qu'une fois
+        for (openPMD::IndexedIteration it : fSeries->readIterations()) {
+            const auto index = it.iterationIndex;
+            if (index < static_cast<std::uint64_t>(std::max(fOpts.iteration, 0))) {
+                it.close();
+                continue;
+            }
+            fParticles = 0;
+            bool complete = true;
+            for (const auto& sp : fOpts.species) {
+                if (it.particles.count(sp.name) == 0) {
+                    G4cerr << "[stream] itération " << index << " : espèce '"
+                           << sp.name << "' absente, ignorée\n";
+                    complete = false;
+                    break;
+                }
+                fParticles += it.particles[sp.name]["momentum"]["x"].getExtent()[0];
+            }
+            if (complete) {
+                wxg4::RunOptions step = fOpts;
+                step.iteration = static_cast<int>(index);
+                complete = fSource->Load(step, fSeries.get(), &it);
+            }
+            // Pas rendu à l'écrivain avant la simulation : WarpX n'attend pas Geant4
+            it.close();
+            if (!complete || fSource->Empty()) continue;
+            fDataDirty = false;
+
+            MyRunAction::SetRunTag("_it" + std::to_string(index));
+            G4cout << "[stream] itération " << index << " : " << fParticles << " particules" << G4endl;
+            if (BeamOn()) ++runs;
+        }
+    } catch (const std::exception& e) {
+        G4cerr << "[stream] openPMD : " << e.what() << "\n";
+        fSeries.reset();
+        MyRunAction::SetRunTag("");
+        return runs ? runs : -1;
+    }
+    MyRunAction::SetRunTag("");
+    G4cout << "[stream] flux fermé après " << runs << " itération(s) simulée(s)" << G4endl;
+    fSeries.reset();
+    fDataDirty = true;
+    return runs;
+}
+
+std::uint64_t MyRunController::ShareEvents(std::uint64_t nEvents) const
+{
+    // Table des poids cumulés globale : la tranche de ce rang couvre
+    // [offset, offset + weight[ sur [0, total[
+    const auto& ws = fSource->Data().ws;
+    const double weight = ws.empty() ? 0. : ws.back();
+    const double offset = fMpi->ExclusiveScan(weight);
+    const double total  = fMpi->Sum(weight);
+    const double u      = fMpi->Broadcast(G4UniformRand());
+
+    // Bornes échangées plutôt que recalculées : la somme des parts vaut nEvents
+    const auto first = fMpi->AllGather(wxg4::systematic_first(nEvents, u, offset, total));
+    const auto rank  = static_cast<std::size_t>(fMpi->Rank());
+    const std::uint64_t last = (rank + 1 < first.size()) ? first[rank + 1] : nEvents;
+    return last > first[rank] ? last - first[rank] : 0;
+}
+
+bool MyRunController::PrepareCheckpoint(std::uint64_t& events) const
+{
+    const std::string output = MyRunAction::OutputFile();
+    const wxg4::Checkpoint checkpoint(fOpts.checkpointDir, output);
+    wxg4::CheckpointManifest manifest;
+    manifest.seed      = fOpts.seed;
+    manifest.events    = fOpts.nEvents;
+    manifest.output    = output;
+    manifest.dataset   = fOpts.dataset;
+    manifest.iteration = fOpts.iteration;
+    manifest.sampler   = wxg4::sampler_name(fOpts.sampler);
+
+    std::string err;
+    wxg4::CheckpointManifest saved;
+    if (fOpts.resume && checkpoint.ReadManifest(saved, err)) {
+        if (saved.seed != manifest.seed || saved.events != manifest.events
+            || saved.output != manifest.output || saved.dataset != manifest.dataset
+            || saved.iteration != manifest.iteration || saved.sampler != manifest.sampler) {
+            G4cerr << "[checkpoint] " << fOpts.checkpointDir << " : run différent (graine "
+                   << saved.seed << ", " << saved.events << " événements, " << saved.output
+                   << ") ; relancer avec les mêmes paramètres ou --resume off\n";
+            return false;
+        }
+        std::vector<std::uint64_t> done;
+        std::vector<wxg4::JournalRow> rows;
+        checkpoint.ReadJournals(done, rows);
+
+        // Tous journalisés mais sortie non écrite : le dernier est resimulé,
+        // pour qu'un run (même d'un événement) verse les hits rejoués
+        if (!done.empty() && done.size() >= manifest.events) {
+            const std::uint64_t last = done.back();
+            done.pop_back();
+            rows.erase(std::remove_if(rows.begin(), rows.end(),
+                                      [last](const auto& r) { return r.event == last; }),
+                       rows.end());
+        }
+        std::vector<std::uint64_t> remaining;
+        remaining.reserve(manifest.events - std::min<std::uint64_t>(done.size(), manifest.events));
+        auto next = done.begin();
+        for (std::uint64_t e = 0; e < manifest.events; ++e) {
+            while (next != done.end() && *next < e) ++next;
+            if (next == done.end() || *next != e) remaining.push_back(e);
+        }
+        G4cout << "[checkpoint] reprise de " << output << " : " << done.size() << " / "
+               << manifest.events << " événements journalisés (" << rows.size()
+               << " hits), " << remaining.size() << " à simuler" << G4endl;
+        events = remaining.size();
+        MyRunAction::SetResume(std::move(remaining), std::move(rows));
+        MyRunAction::SetCheckpoint(fOpts.checkpointDir, fOpts.checkpointEvery,
+                                   checkpoint.NextGeneration());
+        return true;
+    }
+
+    // Pas de manifeste mais la sortie existe : run terminé, points supprimés
+    std::error_code ec;
+    if (fOpts.resume && std::filesystem::exists(output, ec)) {
+        G4cout << "[checkpoint] " << output << " déjà terminé, run ignoré" << G4endl;
+        events = 0;
+        return true;
+    }
+
+    checkpoint.Remove();
+    if (!checkpoint.WriteManifest(manifest, err)) {
+        G4cerr << "[checkpoint] " << err << "\n";
+        return false;
+    }
+    MyRunAction::SetResume({}, {});
+    MyRunAction::SetCheckpoint(fOpts.checkpointDir, fOpts.checkpointEvery, 0);
+    G4cout << "[checkpoint] " << output << " : journal tous les " << fOpts.checkpointEvery
+           << " événements dans " << fOpts.checkpointDir << G4endl;
+    return true;
+}
+
+void MyRunController::ReduceProfile() const
+{
+    // Tous les rangs participent ; le rang 0 affiche et écrit le total
+    wxg4::Profiler total;
+    wxg4::reduce_profile(*fMpi, wxg4::Profiler::Instance(), total);
+    if (fMpi->Rank() != 0) return;
+    G4cout << "[mpi] total des " << fMpi->Size() << " rangs :" << G4endl;
+    total.Print(std::cout);
+    if (!fMpiProfile.empty()) {
+        if (total.Write(fMpiProfile)) {
+            G4cout << "[mpi] profil total écrit dans " << fMpiProfile << G4endl;
+        } else {
+            G4cerr << "[mpi] impossible d'écrire " << fMpiProfile << "\n";
+        }
+    }
+    // Hits : un fichier par rang, recombinés par merge_shards
+    std::string pattern = MyRunAction::OutputFile();
+    const std::string suffix = wxg4::shard_suffix(fOpts.shard);
+    pattern.replace(pattern.find(suffix), suffix.size(), "_shard*");
+    pattern.replace(pattern.size() - 5, 5, ".shard");
+    G4cout << "[mpi] hits par rang ; fichier unique : merge_shards <sortie>.root "
+           << pattern << G4endl;
+}
+
+void MyRunController::WriteShardSummary() const
+{
+    // Bilan à côté de la sortie : output_shard03of16.root -> .shard
+    wxg4::ShardSummary summary;
+    summary.shard     = fOpts.shard;
+    summary.seed      = fOpts.seed;
+    summary.particles = fSource->Data().px.size();
+    summary.events    = fOpts.nEvents;
+    summary.weight    = fSource->Data().ws.empty() ? 0. : fSource->Data().ws.back();
+    summary.output    = MyRunAction::OutputFile();
+
+    const std::string path =
+        summary.output.substr(0, summary.output.size() - std::string(".root").size()) + ".shard";
+    std::string err;
+    if (wxg4::write_shard_summary(path, summary, err)) {
+        G4cout << "[shard] " << fOpts.shard.index << "/" << fOpts.shard.count
+               << " : bilan écrit dans " << path << G4endl;
+    } else {
+        G4cerr << "[shard] " << err << "\n";
+    }
+}
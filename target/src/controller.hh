@@ -0,0 +1,101 @@
+// src/controller.hh
+#ifndef CONTROLLER_HH
+#define CONTROLLER_HH
+
+#include <G4Types.hh>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "options.hh"
+#include "source.hh"
+#include "mpi.hh"
+
+class G4RunManager;
+class MyDetectorConstruction;
+namespace openPMD { class Series; }
+
+/**
+ * Enchaîne les runs d'un même processus : la série OpenPMD, les
+ * particules filtrées, la géométrie et les tables physiques restent en
+ * place ; seul ce qui a changé depuis le run précédent est refait
+ * (relecture des données, épaisseur, coupures, nom de sortie).
+ * Utilisé par main (ligne de commande) et par MyMessenger (/wxg4/).
+ * Shard (--shard k/N) : sorties suffixées et bilan .shard après chaque run.
+ * MPI : un shard par rang, série ouverte sur le communicateur, événements
+ * répartis selon le poids des tranches, profil total écrit par le rang 0.
+ * Points de reprise (--checkpoint) : manifeste écrit avant chaque run,
+ * vérifié et complété par les journaux à la reprise (--resume on).
+ */
+class MyRunController
+{
+public:
+    MyRunController(wxg4::RunOptions& opts,
+                    G4RunManager* runManager,
+                    MyDetectorConstruction* detector,
+                    wxg4::ParticleSource* source);
+    ~MyRunController();
+
+    // Données : relues au prochain run
+    void SetDataset(const std::string& path);
+    bool SetSpecies(const std::string& list);
+    void SetIteration(int iteration);
+    bool SetFraction(double pct);
+    /// Réservoir refusé avec --bias
+    bool SetSampler(wxg4::Sampler sampler);
+
+    // Géométrie et sorties
+    bool SetThickness(G4double thickness);
+    bool SetRegionCuts(G4double cutTarget, G4double cutDetector);
+    void SetOutput(const std::string& name);
+    /// Avant /run/initialize uniquement, gestionnaire multithread
+    bool SetThreads(int n);
+    /// Run MPI (mpi->Active()) : profile = fichier du profil total (vide = aucun)
+    void SetMpi(const wxg4::MpiSession* mpi, const std::string& profile);
+
+    /**
+     * Lit les données si besoin, initialise Geant4 si besoin et prépare
+     * l'index de tirages. nEvents = 0 : fraction du dataset.
+     */
+    bool Prepare(std::uint64_t nEvents = 0);
+    /// Prepare() puis BeamOn (puis bilan du shard)
+    bool BeamOn(std::uint64_t nEvents = 0);
+
+    /**
+     * --stream : lit les itérations du flux opts.dataset (ADIOS2 SST) à
+     * mesure que l'écrivain les publie ; chacune (>= opts.iteration) est
+     * copiée, rendue à l'écrivain, puis simulée (sorties _it<N>).
+     * Revient quand l'écrivain ferme le flux.
+     * @return nombre d'itérations simulées, -1 si le flux ne s'ouvre pas
+     */
+    long StreamRuns();
+
+    const wxg4::RunOptions& Options() const { return fOpts; }
+
+private:
+    bool LoadData();
+    /// MPI : part de ce rang dans un tirage global de nEvents événements
+    std::uint64_t ShareEvents(std::uint64_t nEvents) const;
+    /**
+     * --checkpoint : manifeste du run, et à la reprise événements restants
+     * et hits à rejouer (MyRunAction::SetResume). events : événements à
+     * simuler, 0 si le run était déjà terminé.
+     * @return false si le point de reprise ne correspond pas au run
+     */
+    bool PrepareCheckpoint(std::uint64_t& events) const;
+    void WriteShardSummary() const;
+    void ReduceProfile() const;
+
+    wxg4::RunOptions&                fOpts;
+    G4RunManager*                    fRunManager;
+    MyDetectorConstruction*          fDetector;
+    wxg4::ParticleSource*            fSource;
+    std::unique_ptr<openPMD::Series> fSeries;
+    bool                             fDataDirty = true;
+    std::uint64_t                    fParticles = 0;   // avant filtrage, toutes espèces (tranche du shard)
+    const wxg4::MpiSession*          fMpi = nullptr;
+    std::string                      fMpiProfile;
+};
+
+#endif // CONTROLLER_HH
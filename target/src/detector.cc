@@ -2,42 +2,53 @@
 
 #include "G4Step.hh"
 #include "G4Track.hh"
-#include "G4RunManager.hh"
-#include "G4AnalysisManager.hh"
+#include "G4StepPoint.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SDManager.hh"
+#include "G4HCofThisEvent.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <algorithm>
+
 MySensitiveDetector::MySensitiveDetector(const G4String& name)
 : G4VSensitiveDetector(name)
-{}
+{
+    collectionName.push_back(kHitsCollection);
+}
 
 MySensitiveDetector::~MySensitiveDetector()
 {}
 
+void MySensitiveDetector::Initialize(G4HCofThisEvent* hce)
+{
+    fHits = new MyPixelHitsCollection(SensitiveDetectorName, collectionName[0]);
+    fHits->GetVector()->reserve(fReserve);
+
+    if (fHCID < 0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(fHits);
+    hce->AddHitsCollection(fHCID, fHits);
+}
+
+void MySensitiveDetector::EndOfEvent(G4HCofThisEvent*)
+{
+    // La collection est détruite avec son événement : on retient sa taille
+    fReserve = std::max(fReserve, fHits->entries());
+}
+
 G4bool MySensitiveDetector::ProcessHits(G4Step* aStep,
                                         G4TouchableHistory*)
 {
-    // 1) Récupère la particule et son vecteur impulsionnel (en MeV/c)
-    G4Track* track    = aStep->GetTrack();
-    auto     momentum = track->GetMomentum();
-    std::cout << "[SensitiveDetector] ProcessHits: momentum = ("
-              << momentum.x() << ", "
-              << momentum.y() << ", "
-              << momentum.z() << ")\n";
-
-    // 2) (Optionnel) ID de l'événement pour traçabilité
-    G4int eventID = G4RunManager::GetRunManager()
-                       ->GetCurrentEvent()->GetEventID();
-    std::cout << "[DEBUG SD] ProcessHits evt=" << eventID << "\n";
-    // 3) Enregistrement uniquement de px, py, pz
-    auto* man = G4AnalysisManager::Instance();
-    man->FillNtupleIColumn(0, eventID);        // colonne 0 : eventID
-    man->FillNtupleDColumn(1, momentum.x());   // colonne 1 : px
-    man->FillNtupleDColumn(2, momentum.y());   // colonne 2 : py
-    man->FillNtupleDColumn(3, momentum.z());   // colonne 3 : pz
-    man->AddNtupleRow(0);
-
-    // 4) Arrête la particule une fois détectée
+    // 1) Impulsion (MeV/c), poids statistique (1 sauf en échantillonnage
+    //    préférentiel), point d'entrée, énergie cinétique et code PDG ;
+    //    l'ID d'événement et le ntuple sont traités en fin d'événement
+    //    par MyEventAction
+    G4Track* track = aStep->GetTrack();
+    const G4StepPoint* pre = aStep->GetPreStepPoint();
+    fHits->insert(new MyPixelHit(track->GetMomentum(), track->GetWeight(),
+                                 pre->GetPosition(), pre->GetKineticEnergy(),
+                                 track->GetDefinition()->GetPDGEncoding()));
+
+    // 2) Arrête la particule une fois détectée
     track->SetTrackStatus(fStopAndKill);
 
     return true;
-}
\ No newline at end of file
+}
@@ -5,16 +5,36 @@
 #include "G4Step.hh"
 #include "G4TouchableHistory.hh"
 
-/// Enregistre uniquement les composantes (px, py, pz) du vecteur impulsionnel
+#include <cstddef>
+
+#include "hit.hh"
+
+/**
+ * Enregistre chaque particule entrant dans un pixel comme un MyPixelHit
+ * (impulsion, poids, point d'entrée, énergie cinétique, code PDG) dans la
+ * collection "PixelHits" de l'événement, puis arrête la trace.
+ */
 class MySensitiveDetector : public G4VSensitiveDetector
 {
 public:
+    /// Nom de la collection de hits, "PixelSD/PixelHits" pour le SD "PixelSD"
+    static constexpr const char* kHitsCollection = "PixelHits";
+
     explicit MySensitiveDetector(const G4String& name);
     ~MySensitiveDetector() override;
 
+    /// Début d'événement : nouvelle collection, réservée à la taille du plus gros événement vu
+    void Initialize(G4HCofThisEvent* hce) override;
+    void EndOfEvent(G4HCofThisEvent* hce) override;
+
     /// Appelé à chaque pas dans un volume sensible
     G4bool ProcessHits(G4Step* aStep,
                        G4TouchableHistory* history) override;
+
+private:
+    MyPixelHitsCollection* fHits     = nullptr;
+    G4int                  fHCID     = -1;
+    std::size_t            fReserve  = 16;
 };
 
 #endif // DETECTOR_HH
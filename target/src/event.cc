@@ -0,0 +1,65 @@
+// src/event.cc
+#include "event.hh"
+
+#include <G4Event.hh>
+#include <G4HCofThisEvent.hh>
+#include <G4SDManager.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <cmath>
+
+#include "run.hh"
+#include "profiler.hh"
+#include "detector.hh"
+#include "volumes.hh"
+
+MyEventAction::MyEventAction(MyRunAction* runAction,
+                             wxg4::ResponseMatrix* response,
+                             std::uint64_t perBin)
+: fRunAction(runAction)
+, fResponse(response)
+, fPerBin(perBin)
+{}
+
+MyEventAction::~MyEventAction() = default;
+
+void MyEventAction::BeginOfEventAction(const G4Event*)
+{
+    if (auto* volumes = fRunAction->GetVolumeProfiler()) volumes->BeginEvent();
+    fStart = std::chrono::steady_clock::now();
+}
+
+void MyEventAction::EndOfEventAction(const G4Event* event)
+{
+    const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - fStart;
+    fRunAction->AddEventTime(dt.count());
+    wxg4::Profiler::Instance().Add(wxg4::Counter::Events);
+
+    // Hits des pixels : versés en bloc, l'ID d'événement est lu une fois
+    if (fHCID < 0) {
+        fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(
+            G4String("PixelSD/") + MySensitiveDetector::kHitsCollection);
+    }
+    auto* hce = event->GetHCofThisEvent();
+    auto* hits = hce ? static_cast<MyPixelHitsCollection*>(hce->GetHC(fHCID)) : nullptr;
+    if (!fResponse) {
+        if (hits) fRunAction->BufferHits(event->GetEventID(), *hits);
+        return;
+    }
+
+    // Matrice de réponse : le bin d'entrée se déduit du numéro d'événement
+    const std::size_t in = wxg4::ResponseBinning::EventBin(
+        event->GetEventID(), fPerBin, fResponse->Binning().NIn());
+    fResponse->AddPrimary(in);
+    if (!hits) return;
+    const auto& bins = fResponse->Binning();
+    for (std::size_t i = 0; i < hits->entries(); ++i) {
+        const MyPixelHit* hit = (*hits)[i];
+        const G4ThreeVector& pos = hit->GetPosition();
+        const std::size_t out = bins.OutputBin(wxg4::hit_class(hit->GetPDG()),
+                                               std::hypot(pos.x(), pos.y()) / mm,
+                                               hit->GetKineticEnergy() / MeV);
+        fResponse->AddHit(in, out, hit->GetWeight());
+    }
+    wxg4::Profiler::Instance().Add(wxg4::Counter::Hits, hits->entries());
+}
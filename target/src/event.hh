@@ -0,0 +1,41 @@
+// src/event.hh
+#ifndef EVENT_HH
+#define EVENT_HH
+
+#include <G4UserEventAction.hh>
+#include <G4Types.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "response.hh"
+
+class MyRunAction;
+
+/// Mesure le temps réel de chaque événement et transmet au RunAction ce temps et les hits des pixels
+class MyEventAction : public G4UserEventAction
+{
+public:
+    /**
+     * @param response  mode matrice de réponse : table de ce thread (prise
+     *                  en charge), remplie à la place du ntuple
+     * @param perBin    événements consécutifs par bin d'entrée
+     */
+    explicit MyEventAction(MyRunAction* runAction,
+                           wxg4::ResponseMatrix* response = nullptr,
+                           std::uint64_t perBin = 0);
+    ~MyEventAction() override;
+
+    void BeginOfEventAction(const G4Event*) override;
+    void EndOfEventAction  (const G4Event*) override;
+
+private:
+    MyRunAction*                          fRunAction;
+    std::chrono::steady_clock::time_point fStart;
+    G4int                                 fHCID = -1;   // collection "PixelSD/PixelHits"
+    std::unique_ptr<wxg4::ResponseMatrix> fResponse;
+    std::uint64_t                         fPerBin;
+};
+
+#endif // EVENT_HH
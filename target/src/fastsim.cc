@@ -0,0 +1,193 @@
+// src/fastsim.cc
+#include "fastsim.hh"
+
+#include <G4FastTrack.hh>
+#include <G4FastStep.hh>
+#include <G4Track.hh>
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4LogicalVolume.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4ParticleTable.hh>
+#include <G4DynamicParticle.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+#include <G4Exception.hh>
+#include <Randomize.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "construction.hh"
+#include "response.hh"
+
+namespace
+{
+
+/// Tolérance sur la position de la face avant / des bords de la cible
+constexpr double kFaceTolerance = 1e-6 * mm;
+
+/// Angle polaire / +z en degrés
+double polar_deg(const G4ThreeVector& dir)
+{
+    return std::acos(std::clamp(dir.z(), -1., 1.)) / deg;
+}
+
+} // namespace
+
+MyTargetFastModel::MyTargetFastModel(const G4String& name, G4Region* region,
+                                     const wxg4::TransmissionKernel* kernel,
+                                     const MyDetectorConstruction* detector)
+: G4VFastSimulationModel(name, region)
+, fKernel(kernel)
+, fDetector(detector)
+{}
+
+G4bool MyTargetFastModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    return fKernel->ParticleIndex(particle.GetPDGEncoding()) >= 0;
+}
+
+G4bool MyTargetFastModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    fBin = -1;
+    if (!fEnabled) return false;
+
+    // Noyaux calibrés pour une autre épaisseur (balayage) : transport détaillé
+    if (std::abs(fKernel->Thickness() - fDetector->GetThickness() / mm) > 1e-6) {
+        if (!fWarned) {
+            G4ExceptionDescription desc;
+            desc << "Noyaux calibrés pour " << fKernel->Thickness() << " mm, cible de "
+                 << fDetector->GetThickness() / mm << " mm : transport détaillé.";
+            G4Exception("MyTargetFastModel", "KernelThickness", JustWarning, desc);
+            fWarned = true;
+        }
+        return false;
+    }
+
+    // Seulement à l'entrée par la face avant, en allant vers les pixels
+    const G4ThreeVector pos = fastTrack.GetPrimaryTrackLocalPosition();
+    const G4ThreeVector dir = fastTrack.GetPrimaryTrackLocalDirection();
+    const double halfZ = 0.5 * fDetector->GetThickness();
+    if (dir.z() <= 0. || pos.z() > -halfZ + kFaceTolerance) return false;
+
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const int particle = fKernel->ParticleIndex(track->GetDefinition()->GetPDGEncoding());
+    fBin = fKernel->Bin(particle, track->GetKineticEnergy() / MeV, polar_deg(dir));
+    return fKernel->Pick(fBin, 0.) != nullptr;
+}
+
+const G4ParticleDefinition* MyTargetFastModel::Definition(int pdg)
+{
+    auto it = fDefs.find(pdg);
+    if (it == fDefs.end()) {
+        it = fDefs.emplace(pdg, G4ParticleTable::GetParticleTable()->FindParticle(pdg)).first;
+    }
+    return it->second;
+}
+
+void MyTargetFastModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const wxg4::TransmissionKernel::History* h = fKernel->Pick(fBin, G4UniformRand());
+
+    const G4ThreeVector pos = fastTrack.GetPrimaryTrackLocalPosition();
+    const G4ThreeVector dir = fastTrack.GetPrimaryTrackLocalDirection();
+    const double ek    = track->GetKineticEnergy();
+    const double scale = (ek / MeV) / h->e0;
+    const double phi   = std::atan2(dir.y(), dir.x());
+    const double c = std::cos(phi), s = std::sin(phi);
+    const double halfZ  = 0.5 * fDetector->GetThickness();
+    const double halfXY = MyDetectorConstruction::kTargetHalfXY - kFaceTolerance;
+    const double time   = track->GetGlobalTime() + 2. * halfZ / c_light;
+
+    fastStep.KillPrimaryTrack();
+    fastStep.ProposePrimaryTrackFinalPosition(G4ThreeVector(pos.x(), pos.y(), halfZ));
+
+    const wxg4::TransmissionKernel::Exit* exits = fKernel->Exits(*h);
+    std::vector<const wxg4::TransmissionKernel::Exit*> kept;
+    kept.reserve(h->count);
+    for (std::uint32_t i = 0; i < h->count; ++i) {
+        if (Definition(exits[i].pdg)) kept.push_back(&exits[i]);
+    }
+    fastStep.SetNumberOfSecondaryTracks(static_cast<G4int>(kept.size()));
+
+    double eout = 0.;
+    for (const auto* x : kept) {
+        // Repère d'azimut nul -> azimut du primaire
+        const double dx = c * x->dx - s * x->dy, dy = s * x->dx + c * x->dy;
+        const G4ThreeVector u(c * x->ux - s * x->uy, s * x->ux + c * x->uy, x->uz);
+        const G4ThreeVector where(std::clamp(pos.x() + dx * mm, -halfXY, halfXY),
+                                  std::clamp(pos.y() + dy * mm, -halfXY, halfXY),
+                                  halfZ);
+        const double e = x->ek * scale * MeV;
+        G4DynamicParticle dyn(Definition(x->pdg), u.unit(), e);
+        G4Track* secondary = fastStep.CreateSecondaryTrack(dyn, where, time, true);
+        if (secondary) secondary->SetWeight(track->GetWeight());
+        eout += e;
+    }
+    fastStep.ProposeTotalEnergyDeposited(std::max(0., ek - eout));
+}
+
+MyCalibrationSteppingAction::MyCalibrationSteppingAction(const MyDetectorConstruction* detector,
+                                                         wxg4::TransmissionKernel* kernel)
+: fDetector(detector)
+, fKernel(kernel)
+{}
+
+MyCalibrationSteppingAction::~MyCalibrationSteppingAction() = default;
+
+void MyCalibrationSteppingAction::UserSteppingAction(const G4Step* step)
+{
+    const G4StepPoint* post = step->GetPostStepPoint();
+    if (post->GetStepStatus() != fGeomBoundary) return;
+
+    const G4VPhysicalVolume* prePV  = step->GetPreStepPoint()->GetPhysicalVolume();
+    const G4VPhysicalVolume* postPV = post->GetPhysicalVolume();
+    const G4LogicalVolume* target = fDetector->GetTargetVolume();
+    const bool fromTarget = prePV  && prePV->GetLogicalVolume()  == target;
+    const bool intoTarget = postPV && postPV->GetLogicalVolume() == target;
+    G4Track* track = step->GetTrack();
+
+    // Entrée du primaire : nouvelle histoire dans son bin
+    if (intoTarget && !fromTarget && track->GetTrackID() == 1) {
+        const G4ThreeVector dir = post->GetMomentumDirection();
+        const double ek = post->GetKineticEnergy() / MeV;
+        const int particle = fKernel->ParticleIndex(track->GetDefinition()->GetPDGEncoding());
+        const long bin = fKernel->Bin(particle, ek, polar_deg(dir));
+        fOpen = bin >= 0;
+        if (!fOpen) {
+            track->SetTrackStatus(fStopAndKill);
+            return;
+        }
+        fEntry = post->GetPosition();
+        const double phi = std::atan2(dir.y(), dir.x());
+        fCosPhi = std::cos(phi);
+        fSinPhi = std::sin(phi);
+        fKernel->BeginHistory(static_cast<std::size_t>(bin), ek);
+        return;
+    }
+
+    // Sortie de la cible : enregistrée seulement par la face arrière (le
+    // modèle rapide ne rend que celle-ci), arrêtée dans tous les cas
+    if (fromTarget && !intoTarget) {
+        const G4ThreeVector dir = post->GetMomentumDirection();
+        const double backZ = MyDetectorConstruction::kTargetZ + 0.5 * fDetector->GetThickness();
+        if (fOpen && dir.z() > 0. && post->GetPosition().z() >= backZ - kFaceTolerance) {
+            const G4ThreeVector d = post->GetPosition() - fEntry;
+            wxg4::TransmissionKernel::Exit x;
+            x.pdg = track->GetDefinition()->GetPDGEncoding();
+            x.ek  = static_cast<float>(post->GetKineticEnergy() / MeV);
+            // Repère d'azimut incident nul (rotation de -phi autour de z)
+            x.dx = static_cast<float>(( fCosPhi * d.x() + fSinPhi * d.y()) / mm);
+            x.dy = static_cast<float>((-fSinPhi * d.x() + fCosPhi * d.y()) / mm);
+            x.ux = static_cast<float>( fCosPhi * dir.x() + fSinPhi * dir.y());
+            x.uy = static_cast<float>(-fSinPhi * dir.x() + fCosPhi * dir.y());
+            x.uz = static_cast<float>(dir.z());
+            fKernel->AddExit(x);
+        }
+        track->SetTrackStatus(fStopAndKill);
+    }
+}
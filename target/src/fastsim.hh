@@ -0,0 +1,79 @@
+// src/fastsim.hh
+#ifndef FASTSIM_HH
+#define FASTSIM_HH
+
+#include <G4VFastSimulationModel.hh>
+#include <G4UserSteppingAction.hh>
+#include <G4ThreeVector.hh>
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include "kernel.hh"
+
+class G4Region;
+class G4LogicalVolume;
+class MyDetectorConstruction;
+
+/**
+ * Transport rapide de la cible : une particule qui entre par la face
+ * avant est remplacée par les sorties d'une histoire de calibration du
+ * même bin (particule, énergie, angle), tournées à son azimut, décalées
+ * à son point d'entrée et mises à l'échelle de son énergie. Hors des
+ * noyaux (particule, bin vide, épaisseur différente), transport détaillé.
+ * Une instance par thread, noyaux partagés en lecture.
+ */
+class MyTargetFastModel : public G4VFastSimulationModel
+{
+public:
+    MyTargetFastModel(const G4String& name, G4Region* region,
+                      const wxg4::TransmissionKernel* kernel,
+                      const MyDetectorConstruction* detector);
+    ~MyTargetFastModel() override = default;
+
+    G4bool IsApplicable(const G4ParticleDefinition& particle) override;
+    G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    void   DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+    /// Validation : coupe le modèle sur tous les threads (transport détaillé)
+    static void SetEnabled(bool on) { fEnabled = on; }
+
+private:
+    const G4ParticleDefinition* Definition(int pdg);
+
+    const wxg4::TransmissionKernel* fKernel;
+    const MyDetectorConstruction*   fDetector;
+    std::map<int, const G4ParticleDefinition*> fDefs;   // cache PDG -> définition
+    long                            fBin = -1;          // bin trouvé par ModelTrigger
+    bool                            fWarned = false;
+
+    static inline std::atomic<bool> fEnabled{true};
+};
+
+/**
+ * Run de calibration (--calibrate-target) : enregistre, pour chaque
+ * primaire entrant dans la cible, les particules qui sortent par la face
+ * arrière, puis les arrête (rien n'est transporté au-delà). Les sorties
+ * par les faces latérales ou avant sont arrêtées sans être enregistrées.
+ */
+class MyCalibrationSteppingAction : public G4UserSteppingAction
+{
+public:
+    /// kernel : table de ce thread (l'action en devient propriétaire)
+    MyCalibrationSteppingAction(const MyDetectorConstruction* detector,
+                                wxg4::TransmissionKernel* kernel);
+    ~MyCalibrationSteppingAction() override;
+
+    void UserSteppingAction(const G4Step* step) override;
+
+private:
+    const MyDetectorConstruction*             fDetector;
+    std::unique_ptr<wxg4::TransmissionKernel> fKernel;
+    G4ThreeVector                             fEntry;      // point d'entrée du primaire
+    double                                    fCosPhi = 1.;
+    double                                    fSinPhi = 0.;
+    bool                                      fOpen = false;   // histoire en cours
+};
+
+#endif // FASTSIM_HH
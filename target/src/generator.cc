@@ -2,97 +2,37 @@
 #include "generator.hh"
 
 #include <G4ParticleTable.hh>
+#include <G4ParticleDefinition.hh>
 #include <G4Event.hh>
+#include <G4PrimaryVertex.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4ThreeVector.hh>
+#include <G4Threading.hh>
 
 #include "G4SystemOfUnits.hh"    // pour MeV
 #include "G4PhysicalConstants.hh"// pour c_light
+#include "Randomize.hh"
 
 // Chargement de l’API OpenPMD via read.hh
 #include "read.hh"
+#include "run.hh"
 
-MyPrimaryGenerator::MyPrimaryGenerator(const std::string& dataset,
-                                       const std::string& species,
-                                       int iteration)
-: fGen{std::random_device{}()}
-{    
-    std::cout << "[Generator] Chargement des données OpenPMD : "
-              << dataset << ", espèce=" << species
-              << ", itération=" << iteration << "\n";
-    fPData = wxg4::read_particle_data_3d(dataset, species, iteration);
-    std::cout << "[Generator] Données chargées ("
-              << fPData.px.size() << " particules)\n";
-
-    // 2) Création du G4ParticleGun
-    fParticleGun = new G4ParticleGun(1);
-    auto particle = G4ParticleTable::GetParticleTable()->FindParticle("e-");
-    fParticleGun->SetParticleDefinition(particle);
-    fParticleGun->SetParticlePosition(G4ThreeVector(0,0,0));
-
-// ────────────────────────────────────────────────────────────────
-// [NOUVEAU] Pré-filtrage T > 1 MeV (corrigé pour ws, sans CDF)
-// ────────────────────────────────────────────────────────────────
-constexpr double c_SI   = 299792458.0;            // m/s
-constexpr double MeV_J  = 1.602176634e-13;        // 1 MeV en Joules
-const    double Tcut_J  = 50.0 * MeV_J;
-
-// masse depuis le gun (en MeV), convertie en kg
-const double m_MeV = fParticleGun->GetParticleDefinition()->GetPDGMass() / MeV; // nombre en MeV
-const double m_J   = m_MeV * MeV_J;
-const double m_kg  = m_J / (c_SI * c_SI);
-
-// si pas de poids dans le fichier, on suppose poids=1
-if (fPData.ws.empty()) {
-    fPData.ws.assign(fPData.px.size(), 1.0);
-}
-
-std::vector<double> px_f, py_f, pz_f, ws_f;
-px_f.reserve(fPData.px.size());
-py_f.reserve(fPData.py.size());
-pz_f.reserve(fPData.pz.size());
-ws_f.reserve(fPData.ws.size());
-
-size_t kept = 0;
-for (size_t i = 0; i < fPData.px.size(); ++i) {
-    const double px = fPData.px[i]; // SI: kg·m/s
-    const double py = fPData.py[i];
-    const double pz = fPData.pz[i];
-    const double p  = std::sqrt(px*px + py*py + pz*pz); // kg·m/s
-
-    const double ratio = p / (m_kg * c_SI);            // p/(m c) (sans unité)
-    const double gamma = std::sqrt(1.0 + ratio*ratio); // γ
-    const double T_J   = (gamma - 1.0) * m_kg * c_SI * c_SI;
-
-    if (T_J > Tcut_J) {
-        px_f.push_back(px);
-        py_f.push_back(py);
-        pz_f.push_back(pz);
-        ws_f.push_back(fPData.ws[i]);
-        ++kept;
+MyPrimaryGenerator::MyPrimaryGenerator(const wxg4::ParticleSource& source, bool eventSeeds)
+: fSource(source)
+, fEventSeeds(eventSeeds)
+{
+    // Graine fixée (shards) : un flux par thread, distinct de celui de la source
+    if (source.Seed() != 0) {
+        fGen.seed(static_cast<std::mt19937::result_type>(
+            wxg4::stream_seed(source.Seed(), G4Threading::G4GetThreadId() + 2)));
+    } else {
+        fGen.seed(std::random_device{}());
     }
-}
-
-const double Tcut_MeV = Tcut_J / MeV_J;
-
-if (px_f.empty()) {
-    G4ExceptionDescription desc;
-    desc << "Aucune particule avec T > " << Tcut_MeV
-         << " MeV — on conserve l'ensemble original.";
-    G4Exception("MyPrimaryGenerator", "HighEnergyFilterEmpty", JustWarning, desc);
-} else {
-    const size_t oldN = fPData.px.size();
-    fPData.px.swap(px_f);
-    fPData.py.swap(py_f);
-    fPData.pz.swap(pz_f);
-    fPData.ws.swap(ws_f);
-    std::cout << "[Generator] Filtrage T > " << Tcut_J / MeV_J << " MeV : "
-              << kept << " / " << oldN << " particules conservées.\n";
-}
 
+    fParticleGun = new G4ParticleGun(1);
+    fParticleGun->SetParticlePosition(G4ThreeVector(0,0,0));
 }
 
-
 MyPrimaryGenerator::~MyPrimaryGenerator()
 {
     delete fParticleGun;
@@ -101,41 +41,86 @@ MyPrimaryGenerator::~MyPrimaryGenerator()
 void MyPrimaryGenerator::GeneratePrimaries(G4Event* anEvent)
 {
     G4int evtID = anEvent->GetEventID();
-    std::cout << "[Generator DEBUG] --- event " << evtID << " ---\n";
 
-    // 1) Tirage pondéré et récupération brute
-    double r = fDist(fGen);
-    auto pm = wxg4::sample_momentum_3d(fPData, r);
-    std::cout << "[Generator DEBUG] raw momentum (from openPMD) = ("
-              << pm[0] << ", " << pm[1] << ", " << pm[2]
-              << ") [SI: kg·m/s]\n";
+    const wxg4::PrimaryTable& table = fSource.Table();
+    const auto& index = fSource.Index();
+
+    // Graines de l'événement dérivées de son numéro dans le run complet :
+    // le tirage et la gerbe Geant4 ne dépendent plus de l'ordre des événements
+    const std::uint64_t event = MyRunAction::GlobalEvent(evtID);
+    if (fEventSeeds) {
+        const std::uint64_t s = wxg4::stream_seed(wxg4::stream_seed(fSource.Seed(), 1), event);
+        const long seeds[3] = {static_cast<long>((s & 0x7fffffff) | 1),
+                               static_cast<long>((s >> 32) & 0x7fffffff), 0};
+        G4Random::setTheSeeds(seeds);
+        fGen.seed(static_cast<std::mt19937::result_type>(s));
+    }
 
-    // 2) Construction du vecteur Geant4 et magnitude en SI
-    G4ThreeVector vec(pm[0], pm[1], pm[2]);
-    G4double p_SI = vec.mag();
-    std::cout << "[Generator DEBUG] |p| raw = " << p_SI
-              << " kg·m/s\n";
+    // 1) Tirage pondéré (table d'alias, ou entrée suivante de l'index)
+    std::size_t idx;
+    if (index.empty()) {
+        idx = table.Draw(fDist(fGen));
+    } else {
+        idx = index[static_cast<std::size_t>(event % index.size())];
+    }
 
-    // 3) Conversion en MeV/c (Geant4 momentum unit)
-    G4double MEV_C_CONVERSION = 5.3442859e-22;
+    // 2) Fiche de la particule : direction et |p| déjà calculés, une ligne de cache
+    const wxg4::PrimaryRecord& rec = table[idx];
+    G4ParticleDefinition* def = fSource.Definitions()[rec.sid];
+    const G4ThreeVector dir(rec.dx, rec.dy, rec.dz);
+    const G4double p_MeV = rec.p;
 
-    G4double p_MeV = p_SI /MEV_C_CONVERSION * MeV;
+    // 3) Configuration du gun
+    fParticleGun->SetParticleDefinition(def);
+    fParticleGun->SetParticleMomentumDirection(dir);
+    fParticleGun->SetParticleMomentum(p_MeV * MeV);
 
-    std::cout << "[Generator DEBUG] p_converted = "
-              << p_MeV << " MeV/c\n";
+    // 4) Tir du vertex, avec le poids compensatoire éventuel
+    // (hérité par la trace, ses secondaires et donc les hits)
+    fParticleGun->GeneratePrimaryVertex(anEvent);
+    if (!fSource.Data().wb.empty()) {
+        anEvent->GetPrimaryVertex()->SetWeight(rec.wb);
+    }
+}
 
-    // 4) Direction normalisée
-    G4ThreeVector dir = vec.unit();
-    std::cout << "[Generator DEBUG] direction = ("
-              << dir.x() << ", " << dir.y() << ", " << dir.z()
-              << ")\n";
+MyResponseGenerator::MyResponseGenerator(const wxg4::ResponseBinning& bins,
+                                         const std::vector<G4ParticleDefinition*>& particles,
+                                         std::uint64_t perBin)
+: fBins(bins)
+, fParticles(particles)
+, fPerBin(perBin)
+{
+    fParticleGun = new G4ParticleGun(1);
+    fParticleGun->SetParticlePosition(G4ThreeVector(0,0,0));
+}
 
-    // 5) Configuration du gun
-    fParticleGun->SetParticleMomentumDirection(dir);
-    fParticleGun->SetParticleMomentum(p_MeV * MeV);
-    std::cout << "[Generator DEBUG] gun configured: p = "
-              << p_MeV << " MeV/c, dir = " << dir << "\n";
+MyResponseGenerator::~MyResponseGenerator()
+{
+    delete fParticleGun;
+}
 
-    // 6) Tir du vertex
+void MyResponseGenerator::GeneratePrimaries(G4Event* anEvent)
+{
+    const std::size_t bin = wxg4::ResponseBinning::EventBin(
+        anEvent->GetEventID(), fPerBin, fParticles.size() * fBins.NIn());
+    const std::size_t in = bin % fBins.NIn();
+    const std::size_t ie = in / fBins.NTheta();
+    const std::size_t it = in % fBins.NTheta();
+    fParticleGun->SetParticleDefinition(fParticles[bin / fBins.NIn()]);
+
+    // Énergie log-uniforme dans [E_i, E_i+1[
+    const G4double e0 = fBins.energy[ie], e1 = fBins.energy[ie + 1];
+    const G4double ek = e0 * std::pow(e1 / e0, G4UniformRand());
+
+    // Direction isotrope dans la couronne [θ_j, θ_j+1[ autour de +z
+    const G4double c0 = std::cos(fBins.theta[it] * deg);
+    const G4double c1 = std::cos(fBins.theta[it + 1] * deg);
+    const G4double cosT = c0 + (c1 - c0) * G4UniformRand();
+    const G4double sinT = std::sqrt(std::max(0., 1. - cosT * cosT));
+    const G4double phi  = twopi * G4UniformRand();
+
+    fParticleGun->SetParticleEnergy(ek * MeV);
+    fParticleGun->SetParticleMomentumDirection(
+        G4ThreeVector(sinT * std::cos(phi), sinT * std::sin(phi), cosT));
     fParticleGun->GeneratePrimaryVertex(anEvent);
-}
\ No newline at end of file
+}
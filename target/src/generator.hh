@@ -8,30 +8,62 @@
 #include <G4ThreeVector.hh>
 #include <random>
 #include <string>
+#include <vector>
 
 // Interface de lecture OpenPMD
 #include "read.hh"
+#include "source.hh"
+#include "response.hh"
+
+class G4ParticleDefinition;
 
 class MyPrimaryGenerator : public G4VUserPrimaryGeneratorAction
 {
 public:
     /**
-     * @param dataset   Chemin vers le dossier OpenPMD (ex: "../3D_dataset")
-     * @param species   Nom de l’espèce dans OpenPMD (ex: "electrons")
-     * @param iteration Numéro d’itération à lire (ex: 100)
+     * @param source      particules chargées par le thread maître, partagées
+     *                    en lecture seule (une instance par thread)
+     * @param eventSeeds  graines fixées par événement (points de reprise) :
+     *                    un événement donne le même résultat quel que soit
+     *                    le thread ou la reprise qui le simule
      */
-    MyPrimaryGenerator(const std::string& dataset,
-                       const std::string& species,
-                       int iteration);
+    explicit MyPrimaryGenerator(const wxg4::ParticleSource& source, bool eventSeeds = false);
     ~MyPrimaryGenerator() override;
 
     void GeneratePrimaries(G4Event* anEvent) override;
 
 private:
     G4ParticleGun*                         fParticleGun{nullptr};
-    wxg4::ParticleData                     fPData;      // px,py,pz et ws
+    const wxg4::ParticleSource&            fSource;     // px,py,pz, ws, sid et index
     std::mt19937                           fGen;        // moteur RNG
+    bool                                   fEventSeeds;
     std::uniform_real_distribution<double> fDist{0.0, 1.0};
 };
 
-#endif // GENERATOR_HH
\ No newline at end of file
+/**
+ * Mode matrice de réponse (et calibration des noyaux de la cible) :
+ * primaires mono-énergétiques par bin d'entrée, énergie tirée en log et
+ * angle polaire en cos θ dans le bin, azimut uniforme. Les événements
+ * d'un même bin sont consécutifs (ResponseBinning::EventBin), ce qui
+ * permet à MyEventAction de retrouver le bin sans information attachée
+ * à l'événement. Plusieurs particules : les bins de la première, puis
+ * ceux de la suivante, etc.
+ */
+class MyResponseGenerator : public G4VUserPrimaryGeneratorAction
+{
+public:
+    MyResponseGenerator(const wxg4::ResponseBinning& bins,
+                        const std::vector<G4ParticleDefinition*>& particles,
+                        std::uint64_t perBin);
+    ~MyResponseGenerator() override;
+
+    void GeneratePrimaries(G4Event* anEvent) override;
+
+private:
+    G4ParticleGun*          fParticleGun{nullptr};
+    wxg4::ResponseBinning              fBins;
+    std::vector<G4ParticleDefinition*> fParticles;
+    std::uint64_t                      fPerBin;
+};
+
+#endif // GENERATOR_HH
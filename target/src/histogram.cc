@@ -0,0 +1,144 @@
+// src/histogram.cc
+#include "histogram.hh"
+
+#include <cmath>
+#include <fstream>
+
+namespace wxg4
+{
+
+HistAxis::HistAxis(const BinSpec& spec, bool log)
+: fSpec(spec)
+, fLog(log && spec.lo > 0.)
+{
+    fLo    = fLog ? std::log(spec.lo) : spec.lo;
+    fScale = spec.n / ((fLog ? std::log(spec.hi) : spec.hi) - fLo);
+}
+
+long HistAxis::Find(double x) const
+{
+    if (!(x >= fSpec.lo)) return std::isnan(x) ? static_cast<long>(fSpec.n) : -1;
+    if (x >= fSpec.hi) return static_cast<long>(fSpec.n);
+    const double u = ((fLog ? std::log(x) : x) - fLo) * fScale;
+    // Arrondi au bord supérieur : ramené dans le dernier bin
+    const long i = static_cast<long>(u);
+    return i < static_cast<long>(fSpec.n) ? i : static_cast<long>(fSpec.n) - 1;
+}
+
+double HistAxis::Edge(unsigned i) const
+{
+    if (i == 0) return fSpec.lo;
+    if (i >= fSpec.n) return fSpec.hi;
+    const double u = fLo + i / fScale;
+    return fLog ? std::exp(u) : u;
+}
+
+Hist1D::Hist1D(const HistAxis& a)
+: axis(a)
+, count(a.N(), 0.)
+, weight(a.N(), 0.)
+, weight2(a.N(), 0.)
+{}
+
+void Hist1D::Fill(double x, double w)
+{
+    const long i = axis.Find(x);
+    if (i < 0) {
+        under += w;
+    } else if (i >= static_cast<long>(axis.N())) {
+        over += w;
+    } else {
+        count[i]   += 1.;
+        weight[i]  += w;
+        weight2[i] += w * w;
+    }
+}
+
+void Hist1D::Add(const Hist1D& other)
+{
+    for (std::size_t i = 0; i < count.size(); ++i) {
+        count[i]   += other.count[i];
+        weight[i]  += other.weight[i];
+        weight2[i] += other.weight2[i];
+    }
+    under += other.under;
+    over  += other.over;
+}
+
+bool Hist1D::WriteCsv(const std::string& path, const std::string& title, std::string& err) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        err = "cannot create " + path;
+        return false;
+    }
+    out.precision(10);
+    out << "# " << title << (axis.Log() ? " (bins log)" : "") << "\n"
+        << "# sous l'axe : " << under << " | au-delà : " << over << "\n"
+        << "lo,hi,count,weight,weight2\n";
+    for (unsigned i = 0; i < axis.N(); ++i) {
+        out << axis.Edge(i) << "," << axis.Edge(i + 1) << "," << count[i] << ","
+            << weight[i] << "," << weight2[i] << "\n";
+    }
+    if (!out) {
+        err = "write error on " + path;
+        return false;
+    }
+    return true;
+}
+
+Hist2D::Hist2D(const HistAxis& ax, const HistAxis& ay)
+: x(ax)
+, y(ay)
+, count(static_cast<std::size_t>(ax.N()) * ay.N(), 0.)
+, weight(static_cast<std::size_t>(ax.N()) * ay.N(), 0.)
+{}
+
+void Hist2D::Fill(double xv, double yv, double w)
+{
+    const long ix = x.Find(xv), iy = y.Find(yv);
+    if (ix < 0 || iy < 0 || ix >= static_cast<long>(x.N()) || iy >= static_cast<long>(y.N())) {
+        outside += w;
+        return;
+    }
+    const std::size_t k = static_cast<std::size_t>(ix) * y.N() + static_cast<std::size_t>(iy);
+    count[k]  += 1.;
+    weight[k] += w;
+}
+
+void Hist2D::Add(const Hist2D& other)
+{
+    for (std::size_t k = 0; k < count.size(); ++k) {
+        count[k]  += other.count[k];
+        weight[k] += other.weight[k];
+    }
+    outside += other.outside;
+}
+
+bool Hist2D::WriteCsv(const std::string& path, const std::string& title, std::string& err) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        err = "cannot create " + path;
+        return false;
+    }
+    out.precision(10);
+    out << "# " << title << " | " << x.N() << " x " << y.N() << " bins, non vides seulement\n"
+        << "# hors axes : " << outside << "\n"
+        << "xlo,xhi,ylo,yhi,count,weight\n";
+    for (unsigned ix = 0; ix < x.N(); ++ix) {
+        for (unsigned iy = 0; iy < y.N(); ++iy) {
+            const std::size_t k = static_cast<std::size_t>(ix) * y.N() + iy;
+            if (count[k] == 0.) continue;
+            out << x.Edge(ix) << "," << x.Edge(ix + 1) << "," << y.Edge(iy) << ","
+                << y.Edge(iy + 1) << "," << count[k] << "," << weight[k] << "\n";
+        }
+    }
+    if (!out) {
+        err = "write error on " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace wxg4
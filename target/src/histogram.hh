@@ -0,0 +1,67 @@
+// src/histogram.hh
+#ifndef HISTOGRAM_HH
+#define HISTOGRAM_HH
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "response.hh"
+
+namespace wxg4
+{
+
+/// Axe régulier, linéaire ou logarithmique (lo > 0), bin trouvé en O(1)
+class HistAxis
+{
+public:
+    HistAxis() = default;
+    HistAxis(const BinSpec& spec, bool log);
+
+    /// Bin de x ; -1 sous lo, N() au-delà de hi (NaN : N())
+    long Find(double x) const;
+    unsigned N() const { return fSpec.n; }
+    bool     Log() const { return fLog; }
+    double   Edge(unsigned i) const;
+
+private:
+    BinSpec fSpec;
+    bool    fLog   = false;
+    double  fLo    = 0.;    // lo, ou log(lo)
+    double  fScale = 0.;    // n / (hi - lo), en log si fLog
+};
+
+/**
+ * Histogramme 1D : nombre d'entrées, somme des poids et des poids au
+ * carré par bin, débordements à part. Un par thread, fusionnés par Add.
+ */
+struct Hist1D {
+    HistAxis            axis;
+    std::vector<double> count, weight, weight2;
+    double              under = 0., over = 0.;   // poids hors axe
+
+    Hist1D() = default;
+    explicit Hist1D(const HistAxis& a);
+    void Fill(double x, double w);
+    void Add(const Hist1D& other);
+    /// "lo,hi,count,weight,weight2" par bin, titre en commentaire
+    bool WriteCsv(const std::string& path, const std::string& title, std::string& err) const;
+};
+
+/// Histogramme 2D ; écrit en creux (bins non vides seulement)
+struct Hist2D {
+    HistAxis            x, y;
+    std::vector<double> count, weight;   // ix * y.N() + iy
+    double              outside = 0.;    // poids hors des deux axes
+
+    Hist2D() = default;
+    Hist2D(const HistAxis& ax, const HistAxis& ay);
+    void Fill(double xv, double yv, double w);
+    void Add(const Hist2D& other);
+    /// "xlo,xhi,ylo,yhi,count,weight" par bin non vide
+    bool WriteCsv(const std::string& path, const std::string& title, std::string& err) const;
+};
+
+} // namespace wxg4
+
+#endif // HISTOGRAM_HH
@@ -0,0 +1,4 @@
+// src/hit.cc
+#include "hit.hh"
+
+G4ThreadLocal G4Allocator<MyPixelHit>* MyPixelHitAllocator = nullptr;
@@ -0,0 +1,57 @@
+// src/hit.hh
+#ifndef HIT_HH
+#define HIT_HH
+
+#include <G4VHit.hh>
+#include <G4THitsCollection.hh>
+#include <G4Allocator.hh>
+#include <G4ThreeVector.hh>
+
+/**
+ * Particule arrivée sur un pixel : impulsion (MeV/c), poids de la trace,
+ * et pour la matrice de réponse position, énergie cinétique et code PDG.
+ * Allouée dans un pool par thread (G4Allocator) : un hit coûte une
+ * écriture en mémoire pendant le pas, le ntuple n'est rempli qu'en fin
+ * d'événement (MyRunAction::BufferHits).
+ */
+class MyPixelHit : public G4VHit
+{
+public:
+    MyPixelHit(const G4ThreeVector& momentum, G4double weight,
+               const G4ThreeVector& position, G4double ekin, G4int pdg)
+    : fMomentum(momentum), fPosition(position), fWeight(weight), fEkin(ekin), fPDG(pdg) {}
+    ~MyPixelHit() override = default;
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void* hit);
+
+    const G4ThreeVector& GetMomentum() const { return fMomentum; }
+    G4double             GetWeight()   const { return fWeight; }
+    const G4ThreeVector& GetPosition() const { return fPosition; }
+    G4double             GetKineticEnergy() const { return fEkin; }
+    G4int                GetPDG()      const { return fPDG; }
+
+private:
+    G4ThreeVector fMomentum;
+    G4ThreeVector fPosition;
+    G4double      fWeight;
+    G4double      fEkin;
+    G4int         fPDG;
+};
+
+using MyPixelHitsCollection = G4THitsCollection<MyPixelHit>;
+
+extern G4ThreadLocal G4Allocator<MyPixelHit>* MyPixelHitAllocator;
+
+inline void* MyPixelHit::operator new(size_t)
+{
+    if (!MyPixelHitAllocator) MyPixelHitAllocator = new G4Allocator<MyPixelHit>;
+    return static_cast<void*>(MyPixelHitAllocator->MallocSingle());
+}
+
+inline void MyPixelHit::operator delete(void* hit)
+{
+    MyPixelHitAllocator->FreeSingle(static_cast<MyPixelHit*>(hit));
+}
+
+#endif // HIT_HH
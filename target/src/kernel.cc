@@ -0,0 +1,219 @@
+// src/kernel.cc
+#include "kernel.hh"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+namespace wxg4
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'W', 'X', 'G', '4', 'T', 'R', 'K', '1'};
+
+std::mutex         gMutex;
+TransmissionKernel gTotal;
+bool               gHasTotal = false;
+
+template <class T>
+void write_vec(std::ostream& out, const std::vector<T>& v)
+{
+    const std::uint64_t n = v.size();
+    out.write(reinterpret_cast<const char*>(&n), sizeof n);
+    out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(n * sizeof(T)));
+}
+
+template <class T>
+bool read_vec(std::istream& in, std::vector<T>& v)
+{
+    std::uint64_t n = 0;
+    in.read(reinterpret_cast<char*>(&n), sizeof n);
+    if (!in || n > (std::uint64_t(1) << 40) / sizeof(T)) return false;
+    v.resize(n);
+    in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(n * sizeof(T)));
+    return static_cast<bool>(in);
+}
+
+} // namespace
+
+TransmissionKernel::TransmissionKernel(const std::vector<std::string>& names,
+                                       const std::vector<int>& pdgs,
+                                       const BinSpec& energy, const BinSpec& theta,
+                                       double thickness_mm)
+: fNames(names)
+, fPdgs(pdgs)
+, fBins(ResponseBinning::Make(energy, theta, BinSpec{0., 1., 1}, BinSpec{1., 2., 1}))
+, fThickness(thickness_mm)
+{}
+
+void TransmissionKernel::BeginHistory(std::size_t bin, double e0_MeV)
+{
+    fHistories.push_back({static_cast<std::uint32_t>(bin), static_cast<float>(e0_MeV),
+                          fExits.size(), 0});
+}
+
+void TransmissionKernel::AddExit(const Exit& exit)
+{
+    if (fHistories.empty()) return;
+    fExits.push_back(exit);
+    ++fHistories.back().count;
+}
+
+void TransmissionKernel::Flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        if (!gHasTotal) {
+            gTotal = TransmissionKernel(*this);
+            gTotal.fHistories.clear();
+            gTotal.fExits.clear();
+            gHasTotal = true;
+        }
+        const std::uint64_t offset = gTotal.fExits.size();
+        for (History h : fHistories) {
+            h.first += offset;
+            gTotal.fHistories.push_back(h);
+        }
+        gTotal.fExits.insert(gTotal.fExits.end(), fExits.begin(), fExits.end());
+    }
+    fHistories.clear();
+    fExits.clear();
+}
+
+bool TransmissionKernel::SaveTotal(const std::string& path, std::string& err)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (!gHasTotal) {
+        err = "no calibration history recorded";
+        return false;
+    }
+    // Tri par bin (stable : ordre des threads conservé dans un bin)
+    std::stable_sort(gTotal.fHistories.begin(), gTotal.fHistories.end(),
+                     [](const History& a, const History& b) { return a.bin < b.bin; });
+    const bool ok = gTotal.Save(path, err);
+    gTotal = TransmissionKernel{};
+    gHasTotal = false;
+    return ok;
+}
+
+bool TransmissionKernel::Save(const std::string& path, std::string& err) const
+{
+    std::error_code ec;
+    const fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+    const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            err = "cannot create " + tmp;
+            return false;
+        }
+        out.write(kMagic, sizeof kMagic);
+        out.write(reinterpret_cast<const char*>(&fThickness), sizeof fThickness);
+        std::string names;
+        for (const auto& n : fNames) names += n + ",";
+        write_vec(out, std::vector<char>(names.begin(), names.end()));
+        write_vec(out, fPdgs);
+        write_vec(out, fBins.energy);
+        write_vec(out, fBins.theta);
+        write_vec(out, fHistories);
+        write_vec(out, fExits);
+        if (!out) {
+            err = "write error on " + tmp;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        err = "cannot rename " + tmp + ": " + ec.message();
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TransmissionKernel::Load(const std::string& path, std::string& err)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        err = "cannot open " + path;
+        return false;
+    }
+    char magic[sizeof kMagic];
+    in.read(magic, sizeof magic);
+    if (!in || std::memcmp(magic, kMagic, sizeof kMagic) != 0) {
+        err = path + " is not a transmission kernel file";
+        return false;
+    }
+    TransmissionKernel k;
+    in.read(reinterpret_cast<char*>(&k.fThickness), sizeof k.fThickness);
+    std::vector<char> names;
+    if (!read_vec(in, names) || !read_vec(in, k.fPdgs)
+        || !read_vec(in, k.fBins.energy) || !read_vec(in, k.fBins.theta)
+        || !read_vec(in, k.fHistories) || !read_vec(in, k.fExits)
+        || k.fBins.energy.size() < 2 || k.fBins.theta.size() < 2) {
+        err = "truncated or corrupt kernel file " + path;
+        return false;
+    }
+    std::string item;
+    for (const char c : names) {
+        if (c != ',') { item += c; continue; }
+        k.fNames.push_back(item);
+        item.clear();
+    }
+    if (k.fNames.size() != k.fPdgs.size()) {
+        err = "corrupt particle list in " + path;
+        return false;
+    }
+    for (const History& h : k.fHistories) {
+        if (h.bin >= k.NBins() || h.first + h.count > k.fExits.size()) {
+            err = "corrupt kernel file " + path;
+            return false;
+        }
+    }
+    k.Index();
+    *this = std::move(k);
+    return true;
+}
+
+void TransmissionKernel::Index()
+{
+    // Histoires triées par bin (SaveTotal) : bornes de chaque bin
+    fBinStart.assign(NBins() + 1, 0);
+    for (const History& h : fHistories) ++fBinStart[h.bin + 1];
+    for (std::size_t b = 0; b < NBins(); ++b) fBinStart[b + 1] += fBinStart[b];
+}
+
+int TransmissionKernel::ParticleIndex(int pdg) const
+{
+    const auto it = std::find(fPdgs.begin(), fPdgs.end(), pdg);
+    return it == fPdgs.end() ? -1 : static_cast<int>(it - fPdgs.begin());
+}
+
+long TransmissionKernel::Bin(int particle, double ek_MeV, double theta_deg) const
+{
+    if (particle < 0) return -1;
+    const long in = fBins.InputBin(ek_MeV, theta_deg);
+    return in < 0 ? -1 : static_cast<long>(particle) * static_cast<long>(fBins.NIn()) + in;
+}
+
+const TransmissionKernel::History* TransmissionKernel::Pick(long bin, double u) const
+{
+    if (bin < 0 || static_cast<std::size_t>(bin) >= NBins()) return nullptr;
+    const std::uint64_t lo = fBinStart[bin], hi = fBinStart[bin + 1];
+    if (hi == lo) return nullptr;
+    const std::uint64_t i = lo + std::min<std::uint64_t>(hi - lo - 1,
+                                                         static_cast<std::uint64_t>(u * double(hi - lo)));
+    return &fHistories[i];
+}
+
+} // namespace wxg4
@@ -0,0 +1,87 @@
+// src/kernel.hh
+#ifndef KERNEL_HH
+#define KERNEL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "response.hh"
+
+namespace wxg4
+{
+
+/**
+ * Noyaux de transmission de la cible : pour chaque particule incidente
+ * et chaque bin (énergie cinétique log x angle polaire / +z), des
+ * histoires complètes enregistrées en transport détaillé lors d'un run
+ * de calibration. Une histoire = les particules sorties par la face
+ * arrière pour un primaire. Positions et directions de sortie sont
+ * exprimées dans le repère où l'azimut incident est nul : la cible est
+ * une dalle d'axe z, une rotation autour de z suffit à les rejouer.
+ */
+class TransmissionKernel
+{
+public:
+    struct Exit {
+        std::int32_t pdg;
+        float        ek;          // MeV
+        float        dx, dy;      // décalage latéral / point d'entrée [mm]
+        float        ux, uy, uz;  // direction de sortie
+    };
+
+    struct History {
+        std::uint32_t bin;        // particule x NIn + bin d'entrée
+        float         e0;         // énergie incidente [MeV]
+        std::uint64_t first;      // premier Exit
+        std::uint32_t count;      // nombre de sorties (0 = absorbé)
+    };
+
+    TransmissionKernel() = default;
+    /// names : particules Geant4 incidentes, pdgs : leurs codes PDG
+    TransmissionKernel(const std::vector<std::string>& names, const std::vector<int>& pdgs,
+                       const BinSpec& energy, const BinSpec& theta, double thickness_mm);
+
+    // --- Calibration (une instance par thread)
+    void BeginHistory(std::size_t bin, double e0_MeV);
+    void AddExit(const Exit& exit);
+    /// Ajoute les histoires de ce thread au total commun, puis les vide
+    void Flush();
+    /// Écrit le total commun (trié par bin) et le vide
+    static bool SaveTotal(const std::string& path, std::string& err);
+
+    bool Save(const std::string& path, std::string& err) const;
+    bool Load(const std::string& path, std::string& err);
+
+    // --- Rejeu
+    /// Indice de la particule incidente, -1 si absente des noyaux
+    int ParticleIndex(int pdg) const;
+    /// Bin (particule, énergie, angle), -1 hors domaine
+    long Bin(int particle, double ek_MeV, double theta_deg) const;
+    /// Histoire choisie uniformément parmi celles du bin (nullptr si aucune) ; u dans [0,1[
+    const History* Pick(long bin, double u) const;
+    const Exit*    Exits(const History& h) const { return fExits.data() + h.first; }
+
+    double                   Thickness() const { return fThickness; }
+    const std::vector<int>&  Particles() const { return fPdgs; }
+    const std::vector<std::string>& Names() const { return fNames; }
+    const ResponseBinning&   Binning()   const { return fBins; }
+    std::size_t              NHistories() const { return fHistories.size(); }
+    std::size_t              NBins() const { return fPdgs.size() * fBins.NIn(); }
+
+private:
+    void Index();
+
+    std::vector<std::string>  fNames;
+    std::vector<int>          fPdgs;
+    ResponseBinning           fBins;        // energy, theta
+    double                    fThickness = 0.;
+    std::vector<History>      fHistories;
+    std::vector<Exit>         fExits;
+    std::vector<std::uint64_t> fBinStart;   // histoires du bin b : [fBinStart[b], fBinStart[b+1])
+};
+
+} // namespace wxg4
+
+#endif // KERNEL_HH
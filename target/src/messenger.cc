@@ -0,0 +1,165 @@
+// src/messenger.cc
+#include "messenger.hh"
+
+#include <G4UIdirectory.hh>
+#include <G4UIcommand.hh>
+#include <G4UIcmdWithAString.hh>
+#include <G4UIcmdWithAnInteger.hh>
+#include <G4UIcmdWithADouble.hh>
+#include <G4UIcmdWithADoubleAndUnit.hh>
+#include <G4UImanager.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4ios.hh>
+
+#include "controller.hh"
+#include "run.hh"
+
+MyMessenger::MyMessenger(MyRunController* controller)
+: fController(controller)
+{
+    fDir = new G4UIdirectory("/wxg4/");
+    fDir->SetGuidance("Paramètres du run WarpX -> Geant4.");
+
+    fDatasetCmd = new G4UIcmdWithAString("/wxg4/dataset", this);
+    fDatasetCmd->SetGuidance("Série OpenPMD à lire (relue au prochain run).");
+    fDatasetCmd->SetParameterName("path", false);
+
+    fSpeciesCmd = new G4UIcmdWithAString("/wxg4/species", this);
+    fSpeciesCmd->SetGuidance("Espèces, séparées par des virgules (ex: electrons,ions:proton).");
+    fSpeciesCmd->SetParameterName("list", false);
+
+    fIterationCmd = new G4UIcmdWithAnInteger("/wxg4/iteration", this);
+    fIterationCmd->SetGuidance("Itération OpenPMD à lire.");
+    fIterationCmd->SetParameterName("iteration", false);
+
+    fFractionCmd = new G4UIcmdWithADouble("/wxg4/fraction", this);
+    fFractionCmd->SetGuidance("Pourcentage de particules simulées par /wxg4/beamOn.");
+    fFractionCmd->SetParameterName("percent", false);
+
+    fSamplerCmd = new G4UIcmdWithAString("/wxg4/sampler", this);
+    fSamplerCmd->SetGuidance("Échantillonneur des primaires.");
+    fSamplerCmd->SetParameterName("sampler", false);
+    fSamplerCmd->SetCandidates("random systematic stratified reservoir");
+
+    fThicknessCmd = new G4UIcmdWithADoubleAndUnit("/wxg4/thickness", this);
+    fThicknessCmd->SetGuidance("Épaisseur de la cible (seule la géométrie est refaite).");
+    fThicknessCmd->SetParameterName("thickness", false);
+    fThicknessCmd->SetUnitCategory("Length");
+    fThicknessCmd->SetDefaultUnit("mm");
+
+    fCutWorldCmd = new G4UIcmdWithADoubleAndUnit("/wxg4/cutWorld", this);
+    fCutWorldCmd->SetGuidance("Coupure de production du monde (/run/setCut).");
+    fCutWorldCmd->SetParameterName("cut", false);
+    fCutWorldCmd->SetUnitCategory("Length");
+    fCutWorldCmd->SetDefaultUnit("mm");
+
+    fCutTargetCmd = new G4UIcmdWithADoubleAndUnit("/wxg4/cutTarget", this);
+    fCutTargetCmd->SetGuidance("Coupure de production de la région TargetRegion.");
+    fCutTargetCmd->SetParameterName("cut", false);
+    fCutTargetCmd->SetUnitCategory("Length");
+    fCutTargetCmd->SetDefaultUnit("mm");
+
+    fCutDetectorCmd = new G4UIcmdWithADoubleAndUnit("/wxg4/cutDetector", this);
+    fCutDetectorCmd->SetGuidance("Coupure de production de la région DetectorRegion.");
+    fCutDetectorCmd->SetParameterName("cut", false);
+    fCutDetectorCmd->SetUnitCategory("Length");
+    fCutDetectorCmd->SetDefaultUnit("mm");
+
+    fOutputCmd = new G4UIcmdWithAString("/wxg4/output", this);
+    fOutputCmd->SetGuidance("Fichier ROOT des runs suivants (défaut output.root).");
+    fOutputCmd->SetParameterName("file", false);
+
+    fThreadsCmd = new G4UIcmdWithAnInteger("/wxg4/threads", this);
+    fThreadsCmd->SetGuidance("Nombre de threads (avant /run/initialize, lancement avec --threads).");
+    fThreadsCmd->SetParameterName("n", false);
+    fThreadsCmd->AvailableForStates(G4State_PreInit);
+
+    fBeamOnCmd = new G4UIcmdWithAnInteger("/wxg4/beamOn", this);
+    fBeamOnCmd->SetGuidance("Lit les données et initialise si besoin, puis lance un run.");
+    fBeamOnCmd->SetGuidance("0 ou absent : fraction du dataset (/wxg4/fraction).");
+    fBeamOnCmd->SetParameterName("events", true);
+    fBeamOnCmd->SetDefaultValue(0);
+    fBeamOnCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+MyMessenger::~MyMessenger()
+{
+    delete fBeamOnCmd;
+    delete fThreadsCmd;
+    delete fOutputCmd;
+    delete fCutDetectorCmd;
+    delete fCutTargetCmd;
+    delete fCutWorldCmd;
+    delete fThicknessCmd;
+    delete fSamplerCmd;
+    delete fFractionCmd;
+    delete fIterationCmd;
+    delete fSpeciesCmd;
+    delete fDatasetCmd;
+    delete fDir;
+}
+
+void MyMessenger::SetNewValue(G4UIcommand* command, G4String value)
+{
+    const auto& opts = fController->Options();
+    bool ok = true;
+
+    if (command == fDatasetCmd) {
+        fController->SetDataset(value);
+    } else if (command == fSpeciesCmd) {
+        ok = fController->SetSpecies(value);
+    } else if (command == fIterationCmd) {
+        fController->SetIteration(G4UIcmdWithAnInteger::GetNewIntValue(value));
+    } else if (command == fFractionCmd) {
+        ok = fController->SetFraction(G4UIcmdWithADouble::GetNewDoubleValue(value));
+    } else if (command == fSamplerCmd) {
+        wxg4::Sampler s;
+        ok = wxg4::parse_sampler(value, s);
+        ok = ok && fController->SetSampler(s);
+    } else if (command == fThicknessCmd) {
+        ok = fController->SetThickness(G4UIcmdWithADoubleAndUnit::GetNewDoubleValue(value));
+    } else if (command == fCutWorldCmd) {
+        const G4double cut = G4UIcmdWithADoubleAndUnit::GetNewDoubleValue(value);
+        G4UImanager::GetUIpointer()->ApplyCommand(
+            "/run/setCut " + G4UIcommand::ConvertToString(cut / mm) + " mm");
+    } else if (command == fCutTargetCmd) {
+        ok = fController->SetRegionCuts(G4UIcmdWithADoubleAndUnit::GetNewDoubleValue(value),
+                                        opts.cutDetector_mm * mm);
+    } else if (command == fCutDetectorCmd) {
+        ok = fController->SetRegionCuts(opts.cutTarget_mm * mm,
+                                        G4UIcmdWithADoubleAndUnit::GetNewDoubleValue(value));
+    } else if (command == fOutputCmd) {
+        fController->SetOutput(value);
+    } else if (command == fThreadsCmd) {
+        ok = fController->SetThreads(G4UIcmdWithAnInteger::GetNewIntValue(value));
+    } else if (command == fBeamOnCmd) {
+        const G4int n = G4UIcmdWithAnInteger::GetNewIntValue(value);
+        ok = fController->BeamOn(n > 0 ? static_cast<std::uint64_t>(n) : 0);
+    }
+
+    if (!ok) {
+        G4cerr << "[wxg4] " << command->GetCommandPath() << " " << value
+               << " : valeur refusée\n";
+    }
+}
+
+G4String MyMessenger::GetCurrentValue(G4UIcommand* command)
+{
+    const auto& opts = fController->Options();
+    if (command == fDatasetCmd)   return opts.dataset;
+    if (command == fIterationCmd) return G4UIcommand::ConvertToString(opts.iteration);
+    if (command == fFractionCmd)  return G4UIcommand::ConvertToString(opts.fraction_pct);
+    if (command == fSamplerCmd)   return wxg4::sampler_name(opts.sampler);
+    if (command == fThicknessCmd) return G4UIcommand::ConvertToString(opts.thickness_mm) + " mm";
+    if (command == fOutputCmd)    return MyRunAction::OutputFile();
+    if (command == fThreadsCmd)   return G4UIcommand::ConvertToString(opts.threads);
+    if (command == fSpeciesCmd) {
+        std::string list;
+        for (const auto& sp : opts.species) {
+            if (!list.empty()) list += ",";
+            list += sp.name + (sp.g4name.empty() ? "" : ":" + sp.g4name);
+        }
+        return list;
+    }
+    return "";
+}
@@ -0,0 +1,60 @@
+// src/messenger.hh
+#ifndef MESSENGER_HH
+#define MESSENGER_HH
+
+#include <G4UImessenger.hh>
+#include <G4String.hh>
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class MyRunController;
+
+/**
+ * Répertoire /wxg4/ : tous les paramètres d'un run, modifiables entre
+ * deux runs depuis une macro, comme run.mac enchaîne les /run/beamOn.
+ *
+ *   /wxg4/dataset     <chemin OpenPMD>
+ *   /wxg4/species     <electrons,positrons,ions:proton>
+ *   /wxg4/iteration   <n>
+ *   /wxg4/fraction    <pourcentage de particules simulées>
+ *   /wxg4/sampler     random|systematic|stratified
+ *   /wxg4/thickness   <valeur> <unité>
+ *   /wxg4/cutWorld    <valeur> <unité>   (équivaut à /run/setCut)
+ *   /wxg4/cutTarget   <valeur> <unité>
+ *   /wxg4/cutDetector <valeur> <unité>
+ *   /wxg4/output      <nom du fichier ROOT>
+ *   /wxg4/threads     <n>                (avant /run/initialize)
+ *   /wxg4/beamOn      [n]                (0 ou absent : fraction du dataset)
+ */
+class MyMessenger : public G4UImessenger
+{
+public:
+    explicit MyMessenger(MyRunController* controller);
+    ~MyMessenger() override;
+
+    void     SetNewValue(G4UIcommand* command, G4String value) override;
+    G4String GetCurrentValue(G4UIcommand* command) override;
+
+private:
+    MyRunController*           fController;
+
+    G4UIdirectory*             fDir;
+    G4UIcmdWithAString*        fDatasetCmd;
+    G4UIcmdWithAString*        fSpeciesCmd;
+    G4UIcmdWithAnInteger*      fIterationCmd;
+    G4UIcmdWithADouble*        fFractionCmd;
+    G4UIcmdWithAString*        fSamplerCmd;
+    G4UIcmdWithADoubleAndUnit* fThicknessCmd;
+    G4UIcmdWithADoubleAndUnit* fCutWorldCmd;
+    G4UIcmdWithADoubleAndUnit* fCutTargetCmd;
+    G4UIcmdWithADoubleAndUnit* fCutDetectorCmd;
+    G4UIcmdWithAString*        fOutputCmd;
+    G4UIcmdWithAnInteger*      fThreadsCmd;
+    G4UIcmdWithAnInteger*      fBeamOnCmd;
+};
+
+#endif // MESSENGER_HH
@@ -0,0 +1,99 @@
+// src/mpi.cc
+#include "mpi.hh"
+
+#include "profiler.hh"
+
+namespace wxg4
+{
+
+#ifdef WXG4_USE_MPI
+
+MpiSession::MpiSession(int& argc, char**& argv)
+{
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (!initialized) {
+        MPI_Init(&argc, &argv);
+        fOwnsMpi = true;
+    }
+    MPI_Comm_rank(MPI_COMM_WORLD, &fRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &fSize);
+}
+
+MpiSession::~MpiSession()
+{
+    if (fOwnsMpi) MPI_Finalize();
+}
+
+std::uint64_t MpiSession::Sum(std::uint64_t v) const
+{
+    std::uint64_t out = 0;
+    MPI_Allreduce(&v, &out, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    return out;
+}
+
+double MpiSession::Sum(double v) const
+{
+    double out = 0.;
+    MPI_Allreduce(&v, &out, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return out;
+}
+
+double MpiSession::Max(double v) const
+{
+    double out = 0.;
+    MPI_Allreduce(&v, &out, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return out;
+}
+
+double MpiSession::ExclusiveScan(double v) const
+{
+    double out = 0.;
+    MPI_Exscan(&v, &out, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    // Résultat non défini au rang 0
+    return fRank == 0 ? 0. : out;
+}
+
+double MpiSession::Broadcast(double v) const
+{
+    MPI_Bcast(&v, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    return v;
+}
+
+std::vector<std::uint64_t> MpiSession::AllGather(std::uint64_t v) const
+{
+    std::vector<std::uint64_t> out(static_cast<std::size_t>(fSize));
+    MPI_Allgather(&v, 1, MPI_UINT64_T, out.data(), 1, MPI_UINT64_T, MPI_COMM_WORLD);
+    return out;
+}
+
+void MpiSession::Barrier() const
+{
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+#else // !WXG4_USE_MPI
+
+MpiSession::MpiSession(int&, char**&) {}
+MpiSession::~MpiSession() = default;
+std::uint64_t MpiSession::Sum(std::uint64_t v) const { return v; }
+double MpiSession::Sum(double v) const { return v; }
+double MpiSession::Max(double v) const { return v; }
+double MpiSession::ExclusiveScan(double) const { return 0.; }
+double MpiSession::Broadcast(double v) const { return v; }
+std::vector<std::uint64_t> MpiSession::AllGather(std::uint64_t v) const { return {v}; }
+void MpiSession::Barrier() const {}
+
+#endif
+
+void reduce_profile(const MpiSession& mpi, const Profiler& local, Profiler& total)
+{
+    for (int s = 0; s < static_cast<int>(Stage::kCount); ++s) {
+        total.AddTime(static_cast<Stage>(s), mpi.Max(local.Seconds(static_cast<Stage>(s))));
+    }
+    for (int c = 0; c < static_cast<int>(Counter::kCount); ++c) {
+        total.Add(static_cast<Counter>(c), mpi.Sum(local.Get(static_cast<Counter>(c))));
+    }
+}
+
+} // namespace wxg4
@@ -0,0 +1,65 @@
+// src/mpi.hh
+#ifndef MPI_HH
+#define MPI_HH
+
+#include <cstdint>
+#include <vector>
+
+#ifdef WXG4_USE_MPI
+#include <mpi.h>
+#endif
+
+namespace wxg4
+{
+
+class Profiler;
+
+/**
+ * Session MPI du processus (build WXG4_USE_MPI, lancé par mpirun) : le
+ * rang r parmi N traite le shard r/N. Sans MPI, ou lancé seul, une
+ * session à un rang dont les réductions renvoient la valeur locale :
+ * l'appelant n'a pas de branche à écrire.
+ */
+class MpiSession
+{
+public:
+    MpiSession(int& argc, char**& argv);
+    ~MpiSession();
+    MpiSession(const MpiSession&)            = delete;
+    MpiSession& operator=(const MpiSession&) = delete;
+
+    int  Rank()   const { return fRank; }
+    int  Size()   const { return fSize; }
+    bool Active() const { return fSize > 1; }
+
+    // Opérations collectives : tous les rangs doivent les appeler
+    std::uint64_t Sum(std::uint64_t v) const;
+    double        Sum(double v) const;
+    double        Max(double v) const;
+    /// Somme des valeurs des rangs < Rank() (0 au rang 0)
+    double        ExclusiveScan(double v) const;
+    /// Valeur du rang 0
+    double        Broadcast(double v) const;
+    /// Valeur de chaque rang, dans l'ordre des rangs
+    std::vector<std::uint64_t> AllGather(std::uint64_t v) const;
+    void          Barrier() const;
+
+#ifdef WXG4_USE_MPI
+    MPI_Comm Comm() const { return MPI_COMM_WORLD; }
+#endif
+
+private:
+    int  fRank = 0;
+    int  fSize = 1;
+    bool fOwnsMpi = false;   // MPI_Init appelé ici (et donc MPI_Finalize)
+};
+
+/**
+ * Total des profils des rangs : compteurs sommés, temps par étape du
+ * rang le plus lent (c'est lui qui fixe la durée du run).
+ */
+void reduce_profile(const MpiSession& mpi, const Profiler& local, Profiler& total);
+
+} // namespace wxg4
+
+#endif // MPI_HH
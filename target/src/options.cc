@@ -0,0 +1,444 @@
+// src/options.cc
+#include "options.hh"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace wxg4
+{
+
+void print_usage(const char* prog)
+{
+    std::fprintf(stderr,
+        "Usage: %s <openPMD_path> <species[,species...]> <iteration> <thickness_mm> [fraction_percent] [options]\n"
+        "       %s <macro.mac> [options]   (paramètres via /wxg4/..., voir help /wxg4/)\n"
+        "  species : nom OpenPMD, éventuellement suivi de :particule_Geant4\n"
+        "            (ex: electrons,positrons,ions:proton)\n"
+        "Options:\n"
+        "  --sampler random|systematic|stratified|reservoir\n"
+        "            random : un tirage pondéré avec remise par événement (défaut)\n"
+        "            systematic/stratified : index de tirages précalculé\n"
+        "            reservoir : échantillon pondéré sans remise tiré pendant une\n"
+        "            lecture par blocs, mémoire proportionnelle à l'échantillon\n"
+        "  --sort none|energy|direction\n"
+        "            réordonne les particules après filtrage (défaut : none)\n"
+        "  --bias <fichier>\n"
+        "            échantillonnage préférentiel en énergie ; une bande par ligne :\n"
+        "            \"Tmin_MeV Tmax_MeV part_des_événements\"\n"
+        "  --kill-geom on|off\n"
+        "            arrête les traces stables qui ne peuvent plus atteindre les pixels\n"
+        "            (défaut : off)\n"
+        "  --kill-emin <MeV>\n"
+        "            arrête les traces sous cette énergie cinétique (défaut : 0, désactivé)\n"
+        "  --kill-cone <deg>\n"
+        "            hors cible, arrête les traces à plus de <deg> de +z (défaut : 180)\n"
+        "  --physics <liste>\n"
+        "            liste physique de référence Geant4 (défaut : QGSP_BERT_EMZ)\n"
+        "  --em fast|opt0|opt4|liv|pen\n"
+        "            remplace l'option EM de la liste (fast = option 1, la plus rapide)\n"
+        "  --cut-world <mm>, --cut-target <mm>, --cut-detector <mm>\n"
+        "            coupures de production du monde, de la cible, des pixels (défaut : 0.7)\n"
+        "  --profile <fichier>|off\n"
+        "            temps par étape et compteurs en fin de run, JSON ou .csv\n"
+        "            (défaut : profile.json)\n"
+        "  --sweep <mm,mm,...>\n"
+        "            un run par épaisseur dans le même processus (particules et\n"
+        "            tables physiques conservées), sorties output_t<mm>mm.root ;\n"
+        "            l'épaisseur positionnelle est alors ignorée\n"
+        "  --cache <dossier>\n"
+        "            cache des particules filtrées et triées, projeté en mémoire\n"
+        "            par les jobs suivants (même dataset, itération, espèces, tri)\n"
+        "  --flush-every <N>\n"
+        "            hits gardés en mémoire et versés au ntuple tous les N\n"
+        "            événements (défaut : 1, à chaque fin d'événement)\n"
+        "  --threads <N>\n"
+        "            nombre de threads Geant4 (défaut : 1, séquentiel)\n"
+        "  --shard <k/N>\n"
+        "            processus k parmi N : lit la tranche k de chaque espèce, tire\n"
+        "            avec son propre flux aléatoire, sorties output_shard<k>of<N>.root\n"
+        "            et .shard (bilan) ; recombinaison : merge_shards\n"
+        "  --seed <S>\n"
+        "            graine de base des flux aléatoires, commune aux N shards\n"
+        "            (défaut : 0, graines Geant4 par défaut hors shards)\n"
+        "  --stream on|off\n"
+        "            <openPMD_path> est un flux (ex: diags/openpmd.sst, moteur ADIOS2\n"
+        "            SST) : chaque itération >= <iteration> est simulée dès sa\n"
+        "            publication, sorties output_it<N>.root (défaut : off)\n"
+        "  --checkpoint <dossier>\n"
+        "            journalise les événements terminés dans <dossier> (graines fixées\n"
+        "            par événement, --seed requis) ; supprimés en fin de run\n"
+        "  --checkpoint-every <N>\n"
+        "            événements entre deux synchronisations du journal (défaut : 1000)\n"
+        "  --resume on|off\n"
+        "            reprend un run interrompu depuis --checkpoint : hits journalisés\n"
+        "            rejoués, seuls les événements manquants simulés (défaut : off)\n"
+        "  --ui on|off\n"
+        "            session interactive après vis.mac/run.mac (défaut : off)\n"
+        "  --response <fichier>\n"
+        "            matrice de réponse du détecteur au lieu d'un run WarpX ; seul\n"
+        "            argument positionnel : <thickness_mm>. Pliage : fold_response\n"
+        "  --response-particle <nom Geant4>   (défaut : e-)\n"
+        "  --response-energy <lo:hi:n>\n"
+        "            bins log en énergie du primaire, MeV (défaut : 50:50000:30)\n"
+        "  --response-angle <lo:hi:n>\n"
+        "            bins en angle polaire / +z, degrés (défaut : 0:30:6)\n"
+        "  --response-radius <lo:hi:n>\n"
+        "            bins en rayon sur le plan des pixels, mm (défaut : 0:1400:28)\n"
+        "  --response-events <N>\n"
+        "            primaires par bin d'entrée (défaut : 10000)\n"
+        "  --fast-target <fichier>\n"
+        "            cible en transport rapide : les particules entrantes sont\n"
+        "            remplacées par des sorties calibrées (même épaisseur)\n"
+        "  --fast-validate on|off\n"
+        "            avec --fast-target : même run en détaillé puis en rapide,\n"
+        "            hits et temps comparés (sorties *_full / *_fast)\n"
+        "  --calibrate-target <fichier>\n"
+        "            run de calibration des noyaux ; seul argument positionnel :\n"
+        "            <thickness_mm>\n"
+        "  --calibrate-particles <p,p,...>   (défaut : e-,e+,gamma)\n"
+        "  --calibrate-energy <lo:hi:n>      MeV, log (défaut : 50:50000:30)\n"
+        "  --calibrate-angle <lo:hi:n>       degrés (défaut : 0:40:8)\n"
+        "  --calibrate-histories <N>         primaires par bin (défaut : 200)\n"
+        "  --profile-volumes <N>\n"
+        "            pas, longueur et temps par volume et particule, un pas\n"
+        "            chronométré sur N (défaut : 0, désactivé ; 64 convient en production)\n",
+        prog ? prog : "read_warpx_particles", prog ? prog : "read_warpx_particles");
+}
+
+bool parse_options(int argc, char** argv, RunOptions& opts, std::string& err)
+{
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            positional.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            err = "missing value for " + arg;
+            return false;
+        }
+        const std::string value = argv[++i];
+
+        if (arg == "--sampler") {
+            if (!parse_sampler(value, opts.sampler)) {
+                err = "unknown sampler '" + value + "'";
+                return false;
+            }
+        } else if (arg == "--sort") {
+            if (!parse_sort_key(value, opts.sort)) {
+                err = "unknown sort key '" + value + "'";
+                return false;
+            }
+        } else if (arg == "--bias") {
+            opts.biasFile = value;
+        } else if (arg == "--kill-geom") {
+            if (value != "on" && value != "off") {
+                err = "--kill-geom expects on or off";
+                return false;
+            }
+            opts.killGeometry = (value == "on");
+        } else if (arg == "--kill-emin") {
+            opts.killEmin_MeV = std::atof(value.c_str());
+        } else if (arg == "--kill-cone") {
+            opts.killCone_deg = std::atof(value.c_str());
+        } else if (arg == "--physics") {
+            opts.physics = value;
+        } else if (arg == "--em") {
+            if (value != "fast" && value != "opt0" && value != "opt4"
+                && value != "liv" && value != "pen") {
+                err = "unknown EM option '" + value + "'";
+                return false;
+            }
+            opts.em = value;
+        } else if (arg == "--cut-world") {
+            opts.cutWorld_mm = std::atof(value.c_str());
+        } else if (arg == "--cut-target") {
+            opts.cutTarget_mm = std::atof(value.c_str());
+        } else if (arg == "--cut-detector") {
+            opts.cutDetector_mm = std::atof(value.c_str());
+        } else if (arg == "--profile") {
+            opts.profile = (value == "off") ? "" : value;
+        } else if (arg == "--sweep") {
+            opts.sweep_mm.clear();
+            std::size_t pos = 0;
+            while (pos < value.size()) {
+                std::size_t comma = value.find(',', pos);
+                if (comma == std::string::npos) comma = value.size();
+                const std::string item = value.substr(pos, comma - pos);
+                pos = comma + 1;
+                if (item.empty()) continue;
+                const double t = std::atof(item.c_str());
+                if (t <= 0.0) {
+                    err = "--sweep thicknesses must be > 0 (got '" + item + "')";
+                    return false;
+                }
+                opts.sweep_mm.push_back(t);
+            }
+            if (opts.sweep_mm.empty()) {
+                err = "--sweep expects a comma-separated list of thicknesses";
+                return false;
+            }
+        } else if (arg == "--cache") {
+            opts.cacheDir = value;
+        } else if (arg == "--flush-every") {
+            const int n = std::atoi(value.c_str());
+            if (n < 1) {
+                err = "--flush-every must be >= 1";
+                return false;
+            }
+            opts.flushEvery = static_cast<unsigned>(n);
+        } else if (arg == "--threads") {
+            opts.threads = std::atoi(value.c_str());
+            if (opts.threads < 1) {
+                err = "--threads must be >= 1";
+                return false;
+            }
+        } else if (arg == "--shard") {
+            if (!parse_shard(value, opts.shard)) {
+                err = "--shard expects k/N with 0 <= k < N";
+                return false;
+            }
+        } else if (arg == "--seed") {
+            opts.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--ui") {
+            if (value != "on" && value != "off") {
+                err = "--ui expects on or off";
+                return false;
+            }
+            opts.ui = (value == "on");
+        } else if (arg == "--stream") {
+            if (value != "on" && value != "off") {
+                err = "--stream expects on or off";
+                return false;
+            }
+            opts.stream = (value == "on");
+        } else if (arg == "--checkpoint") {
+            opts.checkpointDir = value;
+        } else if (arg == "--checkpoint-every") {
+            const long n = std::atol(value.c_str());
+            if (n < 1) {
+                err = "--checkpoint-every must be >= 1";
+                return false;
+            }
+            opts.checkpointEvery = static_cast<unsigned>(n);
+        } else if (arg == "--resume") {
+            if (value != "on" && value != "off") {
+                err = "--resume expects on or off";
+                return false;
+            }
+            opts.resume = (value == "on");
+        } else if (arg == "--response") {
+            opts.response = value;
+        } else if (arg == "--response-particle") {
+            opts.responseParticle = value;
+        } else if (arg == "--response-energy" || arg == "--response-angle"
+                   || arg == "--response-radius") {
+            BinSpec& spec = (arg == "--response-energy") ? opts.responseEnergy
+                          : (arg == "--response-angle")  ? opts.responseAngle
+                                                         : opts.responseRadius;
+            if (!parse_bin_spec(value, spec)) {
+                err = arg + " expects lo:hi:n with lo < hi and n >= 1 (got '" + value + "')";
+                return false;
+            }
+        } else if (arg == "--response-events") {
+            opts.responseEvents = std::strtoull(value.c_str(), nullptr, 10);
+            if (opts.responseEvents == 0) {
+                err = "--response-events must be >= 1";
+                return false;
+            }
+        } else if (arg == "--fast-target") {
+            opts.fastTarget = value;
+        } else if (arg == "--fast-validate") {
+            if (value != "on" && value != "off") {
+                err = "--fast-validate expects on or off";
+                return false;
+            }
+            opts.fastValidate = (value == "on");
+        } else if (arg == "--calibrate-target") {
+            opts.calibrateTarget = value;
+        } else if (arg == "--calibrate-particles") {
+            opts.calibrateParticles.clear();
+            std::size_t pos = 0;
+            while (pos < value.size()) {
+                std::size_t comma = value.find(',', pos);
+                if (comma == std::string::npos) comma = value.size();
+                const std::string item = value.substr(pos, comma - pos);
+                pos = comma + 1;
+                if (!item.empty()) opts.calibrateParticles.push_back(item);
+            }
+            if (opts.calibrateParticles.empty()) {
+                err = "--calibrate-particles expects a comma-separated list of Geant4 particles";
+                return false;
+            }
+        } else if (arg == "--calibrate-energy" || arg == "--calibrate-angle") {
+            BinSpec& spec = (arg == "--calibrate-energy") ? opts.calibrateEnergy
+                                                          : opts.calibrateAngle;
+            if (!parse_bin_spec(value, spec)) {
+                err = arg + " expects lo:hi:n with lo < hi and n >= 1 (got '" + value + "')";
+                return false;
+            }
+        } else if (arg == "--calibrate-histories") {
+            opts.calibrateHistories = std::strtoull(value.c_str(), nullptr, 10);
+            if (opts.calibrateHistories == 0) {
+                err = "--calibrate-histories must be >= 1";
+                return false;
+            }
+        } else if (arg == "--profile-volumes") {
+            opts.volumeSamplePeriod = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else {
+            err = "unknown option " + arg;
+            return false;
+        }
+    }
+
+    // Macro : les paramètres viennent des commandes /wxg4/
+    if (positional.size() == 1 && positional[0].size() > 4
+        && positional[0].compare(positional[0].size() - 4, 4, ".mac") == 0) {
+        opts.macro = positional[0];
+        return true;
+    }
+
+    if (opts.stream && (!opts.response.empty() || !opts.calibrateTarget.empty() || opts.ui
+                        || opts.fastValidate || opts.shard.Active() || !opts.sweep_mm.empty())) {
+        err = "--stream runs one batch per published iteration "
+              "(no --response, --calibrate-target, --ui, --fast-validate, --shard, --sweep)";
+        return false;
+    }
+
+    if (opts.sampler == Sampler::Reservoir && !opts.biasFile.empty()) {
+        err = "--sampler reservoir already carries the sampling weights (no --bias)";
+        return false;
+    }
+
+    if (opts.resume && opts.checkpointDir.empty()) {
+        err = "--resume on requires --checkpoint <dir>";
+        return false;
+    }
+
+    if (!opts.checkpointDir.empty()) {
+        if (opts.seed == 0) {
+            err = "--checkpoint requires a fixed --seed (per-event seeds are derived from it)";
+            return false;
+        }
+        if (!opts.response.empty() || !opts.calibrateTarget.empty() || opts.stream || opts.ui
+            || opts.fastValidate) {
+            err = "--checkpoint applies to WarpX batch runs only "
+                  "(no --response, --calibrate-target, --stream, --ui, --fast-validate)";
+            return false;
+        }
+    }
+
+    if (opts.shard.Active() && (!opts.response.empty() || !opts.calibrateTarget.empty() || opts.ui)) {
+        err = "--shard splits WarpX batch runs only (no --response, --calibrate-target, --ui)";
+        return false;
+    }
+
+    if (opts.fastValidate && (opts.fastTarget.empty() || !opts.sweep_mm.empty())) {
+        err = "--fast-validate requires --fast-target and a single thickness (no --sweep)";
+        return false;
+    }
+
+    // Matrice de réponse, calibration : pas de données WarpX, seulement l'épaisseur
+    if (!opts.response.empty() || !opts.calibrateTarget.empty()) {
+        const std::string mode = opts.response.empty() ? "--calibrate-target" : "--response";
+        if (!opts.response.empty() && !opts.calibrateTarget.empty()) {
+            err = "--response and --calibrate-target are exclusive";
+            return false;
+        }
+        if (positional.size() != 1) {
+            err = mode + " expects a single positional argument <thickness_mm>";
+            return false;
+        }
+        if (!opts.calibrateTarget.empty() && !opts.sweep_mm.empty()) {
+            err = "--calibrate-target calibrates a single thickness (no --sweep)";
+            return false;
+        }
+        if (opts.calibrateEnergy.lo <= 0.0) {
+            err = "--calibrate-energy lower edge must be > 0 (log bins)";
+            return false;
+        }
+        opts.thickness_mm = std::atof(positional[0].c_str());
+        if (opts.thickness_mm <= 0.0) {
+            err = "thickness_mm must be > 0.";
+            return false;
+        }
+        if (opts.responseEnergy.lo <= 0.0) {
+            err = "--response-energy lower edge must be > 0 (log bins)";
+            return false;
+        }
+        return true;
+    }
+
+    if (positional.size() < 4) {
+        err = "missing positional arguments";
+        return false;
+    }
+
+    opts.dataset      = positional[0];
+    opts.species      = parse_species_list(positional[1]);
+    opts.iteration    = std::stoi(positional[2]);
+    opts.thickness_mm = std::atof(positional[3].c_str());
+    if (positional.size() >= 5) {
+        opts.fraction_pct = std::atof(positional[4].c_str());
+    }
+
+    if (opts.thickness_mm <= 0.0) {
+        err = "thickness_mm must be > 0.";
+        return false;
+    }
+    if (opts.fraction_pct <= 0.0) {
+        err = "fraction_percent must be > 0.";
+        return false;
+    }
+    if (opts.species.empty()) {
+        err = "at least one species must be given.";
+        return false;
+    }
+    if (opts.cutWorld_mm <= 0.0 || opts.cutTarget_mm <= 0.0 || opts.cutDetector_mm <= 0.0) {
+        err = "production cuts must be > 0.";
+        return false;
+    }
+    return true;
+}
+
+ResponseBinning response_binning(const RunOptions& opts)
+{
+    const BinSpec eout{0.1, opts.responseEnergy.hi, 40};
+    return ResponseBinning::Make(opts.responseEnergy, opts.responseAngle,
+                                 opts.responseRadius, eout);
+}
+
+std::string physics_list_name(const std::string& base, const std::string& em)
+{
+    if (em.empty()) return base;
+
+    // Retire un suffixe EM connu de la base (ex: QGSP_BERT_EMZ -> QGSP_BERT)
+    std::string name = base;
+    for (const char* suffix : {"_EMV", "_EMX", "_EMY", "_EMZ", "_LIV", "_PEN",
+                               "__GS", "__SS", "_EM0", "_WVI", "_LE"}) {
+        const std::string sfx = suffix;
+        if (name.size() > sfx.size()
+            && name.compare(name.size() - sfx.size(), sfx.size(), sfx) == 0) {
+            name.erase(name.size() - sfx.size());
+            break;
+        }
+    }
+
+    if      (em == "fast") name += "_EMV";
+    else if (em == "opt4") name += "_EMZ";
+    else if (em == "liv")  name += "_LIV";
+    else if (em == "pen")  name += "_PEN";
+    return name;
+}
+
+std::string physics_label(const RunOptions& opts)
+{
+    char cuts[128];
+    std::snprintf(cuts, sizeof cuts, "cuts monde/cible/pixels=%g/%g/%g mm",
+                  opts.cutWorld_mm, opts.cutTarget_mm, opts.cutDetector_mm);
+    return physics_list_name(opts.physics, opts.em) + ", " + cuts;
+}
+
+} // namespace wxg4
@@ -0,0 +1,105 @@
+// src/options.hh
+#ifndef OPTIONS_HH
+#define OPTIONS_HH
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+#include "sampling.hh"
+#include "reorder.hh"
+#include "response.hh"
+#include "shard.hh"
+
+namespace wxg4
+{
+
+/// Paramètres d'un run, lus sur la ligne de commande
+struct RunOptions {
+    // Macro Geant4 (/wxg4/...) : remplace les arguments positionnels
+    std::string              macro;
+
+    // Arguments positionnels
+    std::string              dataset;              // dossier/fichier OpenPMD
+    std::vector<SpeciesSpec> species;              // espèces à charger
+    int                      iteration    = 0;
+    double                   thickness_mm = 0.0;   // épaisseur de la cible
+    double                   fraction_pct = 10.0;  // % de particules simulées
+
+    // Options "--clé valeur"
+    Sampler                  sampler = Sampler::Random;
+    SortKey                  sort    = SortKey::None;
+    std::string              biasFile;             // spectre cible (vide = pas de biais)
+    bool                     killGeometry = false; // arrêt des traces hors d'atteinte
+    double                   killEmin_MeV = 0.0;   // plancher en énergie (0 = aucun)
+    double                   killCone_deg = 180.0; // cône autour de +z (180 = aucun)
+    std::string              physics = "QGSP_BERT_EMZ"; // liste de référence Geant4
+    std::string              em;                   // option EM (vide = celle de la liste)
+    double                   cutWorld_mm    = 0.7; // coupures de production par région
+    double                   cutTarget_mm   = 0.7;
+    double                   cutDetector_mm = 0.7;
+    std::string              profile = "profile.json"; // résumé du run (.json/.csv, "off" = aucun)
+    std::vector<double>      sweep_mm;             // balayage d'épaisseurs (vide = un seul run)
+    std::string              cacheDir;             // cache de particules préfiltrées (vide = aucun)
+    unsigned                 volumeSamplePeriod = 0;   // profil par volume, 1 pas chronométré sur N (0 = désactivé)
+    unsigned                 flushEvery = 1;       // événements par versement des hits au ntuple
+    int                      threads = 1;          // > 1 : gestionnaire multithread
+    Shard                    shard;                // tranche k/N des particules (--shard)
+    std::uint64_t            seed = 0;             // graine de base (0 = graines par défaut)
+    bool                     ui      = false;      // session interactive (vis.mac, run.mac)
+    bool                     stream  = false;      // dataset = flux openPMD (ADIOS2 SST), un run par itération
+    std::string              checkpointDir;        // journaux de reprise (vide = aucun)
+    unsigned                 checkpointEvery = 1000;   // événements entre deux synchronisations
+    bool                     resume  = false;      // reprise du run depuis checkpointDir
+
+    // Matrice de réponse (--response) : seul positionnel, l'épaisseur
+    std::string              response;             // fichier de sortie (vide = run WarpX)
+    std::string              responseParticle = "e-";
+    BinSpec                  responseEnergy{50., 50000., 30};  // MeV, log
+    BinSpec                  responseAngle{0., 30., 6};        // deg / +z
+    BinSpec                  responseRadius{0., 1400., 28};    // mm sur le plan des pixels
+    std::uint64_t            responseEvents = 10000;           // primaires par bin d'entrée
+
+    // Transport rapide de la cible par noyaux de transmission
+    std::string              fastTarget;           // noyaux à rejouer (vide = transport détaillé)
+    bool                     fastValidate = false; // run détaillé puis rapide, comparés
+    std::string              calibrateTarget;      // run de calibration -> fichier de noyaux
+    std::vector<std::string> calibrateParticles{"e-", "e+", "gamma"};
+    BinSpec                  calibrateEnergy{50., 50000., 30};  // MeV, log
+    BinSpec                  calibrateAngle{0., 40., 8};        // deg / +z
+    std::uint64_t            calibrateHistories = 200;          // primaires par bin
+
+    // Déduit dans main une fois la série ouverte
+    std::uint64_t            nEvents = 0;
+};
+
+void print_usage(const char* prog);
+
+/**
+ * Nom de la liste physique à demander à G4PhysListFactory : base + option
+ * EM. em = "fast" (_EMV, option 1), "opt0" (aucun suffixe), "opt4" (_EMZ),
+ * "liv" (_LIV), "pen" (_PEN) remplace le suffixe EM éventuel de base ;
+ * em vide renvoie base tel quel.
+ */
+std::string physics_list_name(const std::string& base, const std::string& em);
+
+/**
+ * Axes de la matrice de réponse : entrée d'après les options, énergie
+ * des hits en log de 0.1 MeV à l'énergie maximale du primaire.
+ */
+ResponseBinning response_binning(const RunOptions& opts);
+
+/// Résumé court de la configuration physique, pour les rapports de débit
+std::string physics_label(const RunOptions& opts);
+
+/**
+ * Lit argv dans opts. Les options "--clé valeur" peuvent apparaître
+ * n'importe où ; les autres arguments sont positionnels.
+ * @return false (avec un message dans err) si la ligne est invalide
+ */
+bool parse_options(int argc, char** argv, RunOptions& opts, std::string& err);
+
+} // namespace wxg4
+
+#endif // OPTIONS_HH
@@ -0,0 +1,80 @@
+// src/primary.cc
+#include "primary.hh"
+
+#include <cmath>
+
+namespace wxg4
+{
+
+void PrimaryTable::Build(const ParticleView& pdata)
+{
+    const std::size_t n = pdata.px.size();
+    fOwned.assign(n, PrimaryRecord{});
+    fRecords = fOwned.data();
+    fSize    = n;
+    if (n == 0) return;
+
+    // 1) Direction, |p| en MeV/c, espèce et poids du primaire
+    for (std::size_t i = 0; i < n; ++i) {
+        const double px = pdata.px[i] / MEV_C_CONVERSION;
+        const double py = pdata.py[i] / MEV_C_CONVERSION;
+        const double pz = pdata.pz[i] / MEV_C_CONVERSION;
+        const double p  = std::sqrt(px * px + py * py + pz * pz);
+        PrimaryRecord& r = fOwned[i];
+        if (p > 0.) {
+            r.dx = static_cast<float>(px / p);
+            r.dy = static_cast<float>(py / p);
+            r.dz = static_cast<float>(pz / p);
+        } else {
+            r.dz = 1.f;
+        }
+        r.p   = static_cast<float>(p);
+        r.wb  = pdata.wb.empty() ? 1.f : static_cast<float>(pdata.wb[i]);
+        r.sid = pdata.sid.empty() ? 0 : pdata.sid[i];
+    }
+
+    // 2) Table d'alias sur les poids individuels, ramenés à une moyenne de 1
+    const double total = (pdata.ws.size() == n) ? pdata.ws.back() : 0.;
+    std::vector<double> q(n, 1.0);
+    if (total > 0.) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const double w = pdata.ws[i] - (i ? pdata.ws[i - 1] : 0.);
+            q[i] = w * static_cast<double>(n) / total;
+        }
+    }
+    std::vector<std::uint32_t> small, large;
+    for (std::size_t i = 0; i < n; ++i) {
+        (q[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        const std::uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        fOwned[s].prob  = static_cast<float>(q[s]);
+        fOwned[s].alias = l;
+        q[l] -= 1.0 - q[s];
+        if (q[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Restes (arrondis) : gardés à coup sûr
+    for (std::uint32_t i : large) { fOwned[i].prob = 1.f; fOwned[i].alias = i; }
+    for (std::uint32_t i : small) { fOwned[i].prob = 1.f; fOwned[i].alias = i; }
+}
+
+void PrimaryTable::Attach(const PrimaryRecord* records, std::size_t n)
+{
+    Clear();
+    fRecords = records;
+    fSize    = n;
+}
+
+void PrimaryTable::Clear()
+{
+    fOwned.clear();
+    fOwned.shrink_to_fit();
+    fRecords = nullptr;
+    fSize    = 0;
+}
+
+} // namespace wxg4
@@ -0,0 +1,79 @@
+// src/primary.hh
+#ifndef PRIMARY_HH
+#define PRIMARY_HH
+
+#include <cstdint>
+#include <vector>
+
+#include "read.hh"
+
+namespace wxg4
+{
+
+/**
+ * Particule prête à tirer, 32 octets alignés : deux par ligne de cache.
+ * Direction et |p| précalculés (GeneratePrimaries ne recalcule plus
+ * rien), et case de la table d'alias de Walker : un tirage lit une seule
+ * fiche, deux si l'alias est retenu, au lieu d'une dichotomie sur ws puis
+ * de px, py, pz dans trois tableaux distincts.
+ * Simple précision : 1e-7 en relatif sur |p| et la direction, très en deçà
+ * de la résolution du détecteur.
+ */
+struct alignas(32) PrimaryRecord {
+    float         dx, dy, dz;   // direction unitaire
+    float         p;            // |p| [MeV/c]
+    float         prob;         // probabilité de garder cette fiche
+    std::uint32_t alias;        // fiche retenue sinon
+    float         wb;           // poids statistique du primaire (1 sans biais)
+    std::uint8_t  sid;          // indice d'espèce
+    std::uint8_t  pad[3];
+};
+static_assert(sizeof(PrimaryRecord) == 32, "PrimaryRecord : 32 octets");
+
+/**
+ * Fiches de toutes les particules, dans l'ordre de ParticleData (une
+ * fiche i par particule i : les index de tirages restent valables), et
+ * table d'alias sur les poids de ws : tirage pondéré en O(1). Les fiches
+ * sont construites ici, ou lues en place dans le cache projeté (Attach).
+ */
+class PrimaryTable
+{
+public:
+    PrimaryTable() = default;
+    // Fiches propres : fRecords pointe dans fOwned, déplacé mais jamais copié
+    PrimaryTable(const PrimaryTable&)            = delete;
+    PrimaryTable& operator=(const PrimaryTable&) = delete;
+    PrimaryTable(PrimaryTable&&)                 = default;
+    PrimaryTable& operator=(PrimaryTable&&)      = default;
+
+    /// Construction en O(N) (méthode de Vose)
+    void Build(const ParticleView& pdata);
+    /// Fiches déjà construites (cache projeté), sans copie ; records doit
+    /// rester valide tant que la table sert
+    void Attach(const PrimaryRecord* records, std::size_t n);
+
+    /// Particule tirée selon les poids avec u dans [0, 1[
+    std::size_t Draw(double u) const
+    {
+        const double x = u * static_cast<double>(fSize);
+        std::size_t i = static_cast<std::size_t>(x);
+        if (i >= fSize) i = fSize - 1;
+        const PrimaryRecord& r = fRecords[i];
+        return (x - static_cast<double>(i) < r.prob) ? i : r.alias;
+    }
+
+    const PrimaryRecord& operator[](std::size_t i) const { return fRecords[i]; }
+    const PrimaryRecord* Records() const { return fRecords; }
+    std::size_t Size()  const { return fSize; }
+    bool        Empty() const { return fSize == 0; }
+    void        Clear();
+
+private:
+    std::vector<PrimaryRecord> fOwned;              // vide si les fiches sont projetées
+    const PrimaryRecord*       fRecords = nullptr;
+    std::size_t                fSize    = 0;
+};
+
+} // namespace wxg4
+
+#endif // PRIMARY_HH
@@ -0,0 +1,168 @@
+// src/profiler.cc
+#include "profiler.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace wxg4
+{
+
+namespace
+{
+
+const char* const kStageNames[] = {
+    "openpmd_load", "filter", "prepare", "cache_load", "geometry",
+    "initialize", "event_loop", "output"
+};
+const char* const kCounterNames[] = {
+    "particles", "kept", "events", "tracks", "steps", "hits", "output_bytes",
+    "killed_tracks"
+};
+
+/// Valeurs dérivées : initialisation physique, débit, goulot probable
+struct Derived {
+    double      physics_init;
+    double      events_per_s;
+    double      steps_per_event;
+    double      hits_per_event;
+    const char* bound;
+};
+
+Derived derive(const Profiler& p)
+{
+    Derived d{};
+    // Initialize = géométrie + physique ; la géométrie est chronométrée à part
+    d.physics_init = std::max(0.0, p.Seconds(Stage::Initialize) - p.Seconds(Stage::Geometry));
+
+    const double events = static_cast<double>(p.Get(Counter::Events));
+    const double loop   = p.Seconds(Stage::EventLoop);
+    d.events_per_s    = loop > 0. ? events / loop : 0.;
+    d.steps_per_event = events > 0. ? p.Get(Counter::Steps) / events : 0.;
+    d.hits_per_event  = events > 0. ? p.Get(Counter::Hits) / events : 0.;
+
+    const double io = p.Seconds(Stage::OpenPMDLoad) + p.Seconds(Stage::Filter)
+                    + p.Seconds(Stage::Prepare) + p.Seconds(Stage::CacheLoad);
+    const double out = p.Seconds(Stage::Output);
+    d.bound = (loop >= io && loop >= out) ? "transport"
+            : (io >= out)                 ? "input" : "output";
+    return d;
+}
+
+} // namespace
+
+Profiler& Profiler::Instance()
+{
+    static Profiler instance;
+    return instance;
+}
+
+double Profiler::Seconds(Stage s) const
+{
+    return 1e-9 * static_cast<double>(
+        fNanos[static_cast<int>(s)].load(std::memory_order_relaxed));
+}
+
+std::uint64_t Profiler::Get(Counter c) const
+{
+    return fCounts[static_cast<int>(c)].load(std::memory_order_relaxed);
+}
+
+void Profiler::AddEventTime(double seconds)
+{
+    const auto ns = static_cast<std::uint64_t>(seconds * 1e9);
+    fEventNanos.fetch_add(ns, std::memory_order_relaxed);
+    fEventCount.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t cur = fEventMin.load(std::memory_order_relaxed);
+    while (ns < cur && !fEventMin.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+    cur = fEventMax.load(std::memory_order_relaxed);
+    while (ns > cur && !fEventMax.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+}
+
+double Profiler::EventTimeMean() const
+{
+    const std::uint64_t n = fEventCount.load(std::memory_order_relaxed);
+    return n ? 1e-9 * static_cast<double>(fEventNanos.load(std::memory_order_relaxed)) / n : 0.;
+}
+
+double Profiler::EventTimeMin() const
+{
+    if (fEventCount.load(std::memory_order_relaxed) == 0) return 0.;
+    return 1e-9 * static_cast<double>(fEventMin.load(std::memory_order_relaxed));
+}
+
+double Profiler::EventTimeMax() const
+{
+    return 1e-9 * static_cast<double>(fEventMax.load(std::memory_order_relaxed));
+}
+
+void Profiler::ResetRun()
+{
+    for (Stage s : {Stage::EventLoop, Stage::Output}) {
+        fNanos[static_cast<int>(s)].store(0, std::memory_order_relaxed);
+    }
+    for (Counter c : {Counter::Events, Counter::Tracks, Counter::Steps,
+                      Counter::Hits, Counter::OutputBytes, Counter::KilledTracks}) {
+        fCounts[static_cast<int>(c)].store(0, std::memory_order_relaxed);
+    }
+    fEventNanos.store(0, std::memory_order_relaxed);
+    fEventCount.store(0, std::memory_order_relaxed);
+    fEventMin.store(~std::uint64_t{0}, std::memory_order_relaxed);
+    fEventMax.store(0, std::memory_order_relaxed);
+}
+
+void Profiler::Print(std::ostream& os) const
+{
+    const Derived d = derive(*this);
+    os << "[Profiler] temps (s) :";
+    for (int s = 0; s < static_cast<int>(Stage::kCount); ++s) {
+        os << " " << kStageNames[s] << "=" << Seconds(static_cast<Stage>(s));
+    }
+    os << " physics_init=" << d.physics_init << "\n"
+       << "[Profiler] " << d.events_per_s << " évt/s, "
+       << d.steps_per_event << " pas/évt, "
+       << d.hits_per_event << " hits/évt, "
+       << Get(Counter::OutputBytes) << " octets écrits"
+       << " -> limité par : " << d.bound << "\n";
+}
+
+bool Profiler::Write(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out) return false;
+
+    const Derived d = derive(*this);
+    std::vector<std::pair<std::string, double>> values;
+    for (int s = 0; s < static_cast<int>(Stage::kCount); ++s) {
+        values.emplace_back(std::string(kStageNames[s]) + "_s",
+                            Seconds(static_cast<Stage>(s)));
+    }
+    values.emplace_back("physics_init_s", d.physics_init);
+    for (int c = 0; c < static_cast<int>(Counter::kCount); ++c) {
+        values.emplace_back(kCounterNames[c],
+                            static_cast<double>(Get(static_cast<Counter>(c))));
+    }
+    values.emplace_back("events_per_s",    d.events_per_s);
+    values.emplace_back("steps_per_event", d.steps_per_event);
+    values.emplace_back("hits_per_event",  d.hits_per_event);
+
+    out.precision(9);
+    const bool csv = path.size() >= 4
+                  && path.compare(path.size() - 4, 4, ".csv") == 0;
+    if (csv) {
+        out << "key,value\n";
+        for (const auto& kv : values) out << kv.first << "," << kv.second << "\n";
+        out << "bound," << d.bound << "\n";
+    } else {
+        out << "{\n";
+        for (const auto& kv : values) {
+            out << "  \"" << kv.first << "\": " << kv.second << ",\n";
+        }
+        out << "  \"bound\": \"" << d.bound << "\"\n}\n";
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace wxg4
@@ -0,0 +1,114 @@
+// src/profiler.hh
+#ifndef PROFILER_HH
+#define PROFILER_HH
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace wxg4
+{
+
+/// Étapes chronométrées d'un run
+enum class Stage : int {
+    OpenPMDLoad,   // lecture des records OpenPMD
+    Filter,        // coupure en énergie
+    Prepare,       // tri, biais, index de tirages
+    CacheLoad,     // lecture du cache préfiltré
+    Geometry,      // MyDetectorConstruction::Construct
+    Initialize,    // G4RunManager::Initialize (géométrie + physique)
+    EventLoop,     // BeamOn, hors écriture finale
+    Output,        // Write + CloseFile du fichier ROOT
+    kCount
+};
+
+/// Compteurs cumulés sur le run
+enum class Counter : int {
+    Particles,     // particules lues
+    Kept,          // particules après filtrage
+    Events,
+    Tracks,
+    Steps,
+    Hits,
+    OutputBytes,   // taille du fichier de sortie
+    KilledTracks,  // traces arrêtées par anticipation (stepping/stacking)
+    kCount
+};
+
+/**
+ * Temps et compteurs du programme, partagés par tous les threads
+ * (atomiques, sans verrou). Les étapes de préparation sont conservées
+ * d'un run à l'autre ; ResetRun() remet à zéro la boucle d'événements.
+ */
+class Profiler
+{
+public:
+    /// Profil du processus
+    static Profiler& Instance();
+    /// Profil vide, pour un total hors processus (somme des rangs MPI)
+    Profiler() = default;
+
+    void AddTime(Stage s, double seconds)
+    {
+        fNanos[static_cast<int>(s)].fetch_add(
+            static_cast<std::uint64_t>(seconds * 1e9), std::memory_order_relaxed);
+    }
+    void Add(Counter c, std::uint64_t n = 1)
+    {
+        fCounts[static_cast<int>(c)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// Durée réelle d'un événement, tous threads confondus
+    void AddEventTime(double seconds);
+
+    double        Seconds(Stage s) const;
+    std::uint64_t Get(Counter c) const;
+    /// Temps par événement [s] : moyen, min, max (0 sans événement)
+    double        EventTimeMean() const;
+    double        EventTimeMin()  const;
+    double        EventTimeMax()  const;
+
+    /// Remet à zéro boucle, sortie et compteurs par événement
+    void ResetRun();
+
+    /// Résumé lisible : temps par étape, évt/s, pas et hits par événement
+    void Print(std::ostream& os) const;
+    /// Résumé machine : CSV si path finit par ".csv", JSON sinon
+    bool Write(const std::string& path) const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, static_cast<int>(Stage::kCount)>   fNanos{};
+    std::array<std::atomic<std::uint64_t>, static_cast<int>(Counter::kCount)> fCounts{};
+    // Temps par événement [ns] : somme, extrêmes
+    std::atomic<std::uint64_t> fEventNanos{0};
+    std::atomic<std::uint64_t> fEventCount{0};
+    std::atomic<std::uint64_t> fEventMin{~std::uint64_t{0}};
+    std::atomic<std::uint64_t> fEventMax{0};
+};
+
+/// Chronomètre une portée et ajoute sa durée à l'étape donnée
+class ScopeTimer
+{
+public:
+    explicit ScopeTimer(Stage s)
+    : fStage(s), fStart(std::chrono::steady_clock::now()) {}
+    ~ScopeTimer()
+    {
+        const std::chrono::duration<double> dt =
+            std::chrono::steady_clock::now() - fStart;
+        Profiler::Instance().AddTime(fStage, dt.count());
+    }
+    ScopeTimer(const ScopeTimer&)            = delete;
+    ScopeTimer& operator=(const ScopeTimer&) = delete;
+
+private:
+    Stage                                 fStage;
+    std::chrono::steady_clock::time_point fStart;
+};
+
+} // namespace wxg4
+
+#endif // PROFILER_HH
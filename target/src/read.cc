@@ -8,57 +8,134 @@
 namespace wxg4
 {
 
+std::vector<SpeciesSpec> parse_species_list(const std::string& list)
+{
+    std::vector<SpeciesSpec> out;
+    std::size_t pos = 0;
+    while (pos <= list.size()) {
+        std::size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        std::string item = list.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (item.empty()) continue;
+
+        SpeciesSpec spec;
+        const std::size_t colon = item.find(':');
+        if (colon != std::string::npos) {
+            spec.name   = item.substr(0, colon);
+            spec.g4name = item.substr(colon + 1);
+        } else {
+            spec.name = item;
+            // Correspondance par préfixe (ex: "electrons_inj" -> e-)
+            auto starts = [&](const char* prefix) {
+                return item.rfind(prefix, 0) == 0;
+            };
+            if      (starts("electron")) spec.g4name = "e-";
+            else if (starts("positron")) spec.g4name = "e+";
+            else if (starts("proton"))   spec.g4name = "proton";
+            else if (starts("photon"))   spec.g4name = "gamma";
+        }
+        out.push_back(spec);
+    }
+    return out;
+}
+
 ParticleData read_particle_data_3d(
     const std::string& filename,
     const std::string& species_name,
     int iteration)
+{
+    return read_particle_data_3d(
+        filename, std::vector<SpeciesSpec>{{species_name, ""}}, iteration);
+}
+
+ParticleData read_particle_data_3d(
+    const std::string& filename,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const Shard& shard)
 {
     std::cout << "[read3D] Ouverture de la série OpenPMD : "
               << filename << std::endl;
 
     openPMD::Series series(
         filename,
-        openPMD::Access::READ_ONLY
+        openPMD::Access::READ_ONLY,
+        OPENPMD_READ_OPTIONS
     );
+    return read_particle_data_3d(series, species, iteration, shard);
+}
+
+ParticleData read_particle_data_3d(
+    openPMD::Series& series,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const Shard& shard)
+{
     auto it = series.iterations[iteration];
+    it.open();
     std::cout << "[read3D] Iteration " << iteration << " chargée." << std::endl;
+    return read_particle_data_3d(it, species, shard);
+}
 
-    // Accès aux datasets
-    auto px = it.particles[species_name]["momentum"]["x"];
-    auto py = it.particles[species_name]["momentum"]["y"];
-    auto pz = it.particles[species_name]["momentum"]["z"];
-    auto w  = it.particles[species_name]["weighting"];
+ParticleData read_particle_data_3d(
+    openPMD::Iteration& it,
+    const std::vector<SpeciesSpec>& species,
+    const Shard& shard)
+{
+    ParticleData pdata;
+    double wsum = 0.0;
 
-    std::cout << "[read3D] Chargement des chunks..." << std::endl;
-    auto px_data = px.loadChunk<double>();
-    auto py_data = py.loadChunk<double>();
-    auto pz_data = pz.loadChunk<double>();
-    auto w_data  = w.loadChunk<double>();
+    for (std::size_t k = 0; k < species.size(); ++k) {
+        const std::string& species_name = species[k].name;
 
-    series.flush();
-    std::cout << "[read3D] Flush terminé." << std::endl;
+        // Accès aux datasets
+        auto px = it.particles[species_name]["momentum"]["x"];
+        auto py = it.particles[species_name]["momentum"]["y"];
+        auto pz = it.particles[species_name]["momentum"]["z"];
+        auto w  = it.particles[species_name]["weighting"];
 
-    // Nombre de particules
-    const std::size_t NP = px.getExtent()[0];
-    std::cout << "[read3D] Nombre de particules = " << NP << std::endl;
+        // Tranche du shard (tout le jeu sans découpage)
+        std::uint64_t first = 0, NP = px.getExtent()[0];
+        if (shard.Active()) shard_range(px.getExtent()[0], shard, first, NP);
+        std::cout << "[read3D] Chargement des chunks (" << species_name
+                  << ", [" << first << ", " << first + NP << "[)..." << std::endl;
+        if (NP == 0) continue;
+        const openPMD::Offset offset{first};
+        const openPMD::Extent extent{NP};
+        auto px_data = px.loadChunk<double>(offset, extent);
+        auto py_data = py.loadChunk<double>(offset, extent);
+        auto pz_data = pz.loadChunk<double>(offset, extent);
+        auto w_data  = w.loadChunk<double>(offset, extent);
 
-    // Pointeurs sur les données brutes
-    const double* v_px = px_data.get();
-    const double* v_py = py_data.get();
-    const double* v_pz = pz_data.get();
-    const double* v_w  = w_data.get();
+        it.seriesFlush();
+        std::cout << "[read3D] Flush terminé." << std::endl;
+        std::cout << "[read3D] Nombre de particules = " << NP << std::endl;
 
-    // Remplissage de la structure de retour
-    ParticleData pdata;
-    pdata.px.assign(v_px, v_px + NP);
-    pdata.py.assign(v_py, v_py + NP);
-    pdata.pz.assign(v_pz, v_pz + NP);
+        // Pointeurs sur les données brutes
+        const double* v_px = px_data.get();
+        const double* v_py = py_data.get();
+        const double* v_pz = pz_data.get();
+        const double* v_w  = w_data.get();
 
-    pdata.ws.resize(NP);
-    std::partial_sum(v_w, v_w + NP, pdata.ws.begin());
+        // Ajout à la fin de la structure de retour
+        pdata.px.insert(pdata.px.end(), v_px, v_px + NP);
+        pdata.py.insert(pdata.py.end(), v_py, v_py + NP);
+        pdata.pz.insert(pdata.pz.end(), v_pz, v_pz + NP);
+        pdata.sid.insert(pdata.sid.end(), NP, static_cast<std::uint8_t>(k));
 
-    std::cout << "[read3D] Poids cumulés : premier = " << pdata.ws.front()
-              << ", dernier = " << pdata.ws.back() << std::endl;
+        // Poids cumulés sur toutes les espèces
+        pdata.ws.reserve(pdata.ws.size() + NP);
+        for (std::size_t i = 0; i < NP; ++i) {
+            wsum += v_w[i];
+            pdata.ws.push_back(wsum);
+        }
+    }
+
+    if (!pdata.ws.empty()) {
+        std::cout << "[read3D] Poids cumulés : premier = " << pdata.ws.front()
+                  << ", dernier = " << pdata.ws.back() << std::endl;
+    }
 
     return pdata;
 }
@@ -111,25 +188,80 @@ ParticleData read_particle_data_2d(
     return pdata;
 }
 
-std::array<double, 3> sample_momentum_3d(
-    const ParticleData& pdata,
-    double rand_0_1)
+std::size_t filter_kinetic_energy(
+    ParticleData& pdata,
+    const std::vector<double>& masses_MeV,
+    double Tcut_MeV)
 {
-    double total = pdata.ws.back();
-    double target = rand_0_1 * total;
+    const std::size_t NP = pdata.px.size();
+
+    // si pas de poids dans le fichier, on suppose poids=1
+    if (pdata.ws.size() != NP) {
+        pdata.ws.resize(NP);
+        for (std::size_t i = 0; i < NP; ++i) pdata.ws[i] = double(i + 1);
+    }
+    if (pdata.sid.size() != NP) {
+        pdata.sid.assign(NP, 0);
+    }
+    pdata.ek.resize(NP);
+
+    // Compactage en place, poids cumulés recalculés
+    // (ws contient des sommes cumulées : poids_i = ws[i] - ws[i-1]).
+    // Rien n'est déplacé tant qu'aucune particule ne passe : si la coupure
+    // rejette tout, pdata reste intact (hormis ek).
+    std::size_t kept = 0;
+    double prev = 0.0;
+    double wsum = 0.0;
+    for (std::size_t i = 0; i < NP; ++i) {
+        const double w = pdata.ws[i] - prev;
+        prev = pdata.ws[i];
 
-    std::cout << "[sample3D] Tirage uniforme rand=" << rand_0_1
-              << " -> cible = " << target
-              << " / total = " << total << std::endl;
+        const double px = pdata.px[i] / MEV_C_CONVERSION; // MeV/c
+        const double py = pdata.py[i] / MEV_C_CONVERSION;
+        const double pz = pdata.pz[i] / MEV_C_CONVERSION;
+        const double m  = masses_MeV[pdata.sid[i]];
+        const double T  = std::sqrt(px*px + py*py + pz*pz + m*m) - m; // MeV
+        pdata.ek[i] = T;
+        if (!(T > Tcut_MeV)) continue;
 
+        wsum += w;
+        pdata.px[kept]  = pdata.px[i];
+        pdata.py[kept]  = pdata.py[i];
+        pdata.pz[kept]  = pdata.pz[i];
+        pdata.sid[kept] = pdata.sid[i];
+        pdata.ek[kept]  = T;
+        pdata.ws[kept]  = wsum;
+        ++kept;
+    }
+    if (kept == 0) return 0;
+
+    pdata.px.resize(kept);
+    pdata.py.resize(kept);
+    pdata.pz.resize(kept);
+    pdata.sid.resize(kept);
+    pdata.ek.resize(kept);
+    pdata.ws.resize(kept);
+    pdata.energy_sorted = false;
+
+    return kept;
+}
+
+std::size_t sample_index_3d(
+    const ParticleData& pdata,
+    double rand_0_1)
+{
+    const double target = rand_0_1 * pdata.ws.back();
     auto it = std::lower_bound(pdata.ws.begin(), pdata.ws.end(), target);
     std::size_t idx = std::distance(pdata.ws.begin(), it);
+    if (idx >= pdata.ws.size()) idx = pdata.ws.size() - 1;
+    return idx;
+}
 
-    std::cout << "[sample3D] Particule choisie idx = " << idx
-              << " (px=" << pdata.px[idx]
-              << ", py=" << pdata.py[idx]
-              << ", pz=" << pdata.pz[idx] << ")" << std::endl;
-
+std::array<double, 3> sample_momentum_3d(
+    const ParticleData& pdata,
+    double rand_0_1)
+{
+    const std::size_t idx = sample_index_3d(pdata, rand_0_1);
     return { pdata.px[idx], pdata.py[idx], pdata.pz[idx] };
 }
 
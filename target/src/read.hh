@@ -4,30 +4,142 @@
 #include <vector>
 #include <string>
 #include <array>
+#include <cstdint>
 #include <cmath>        // pour std::sin, std::cos
 #include <algorithm>    // pour std::lower_bound
 #include <numeric>      // pour std::partial_sum
 
+#include "shard.hh"
+
+namespace openPMD { class Series; class Iteration; }
+
 namespace wxg4
 {
 
+/// Options d'ouverture en lecture : seules les itérations ouvertes
+/// explicitement (Iteration::open) voient leurs métadonnées analysées
+static constexpr const char* OPENPMD_READ_OPTIONS =
+    R"({"defer_iteration_parsing": true})";
+
 static constexpr double PI = 3.14159265358979323846;
 
+// 1 MeV/c exprimé en kg·m/s (unité des impulsions WarpX)
+static constexpr double MEV_C_CONVERSION = 5.3442859e-22;
+
 struct ParticleData {
     std::vector<double> px, py, pz;
-    std::vector<double> ws;  // somme cumulée des poids
+    std::vector<double> ws;            // somme cumulée des poids
+    std::vector<std::uint8_t> sid;     // indice d'espèce (dans la liste chargée)
+    std::vector<double> ek;            // énergie cinétique [MeV] (remplie par le filtre)
+    std::vector<double> wb;            // poids statistique du primaire (vide = 1)
+    bool energy_sorted = false;        // vrai si trié par ek croissante
+};
+
+/// Colonne en lecture seule : vecteur d'un ParticleData ou tableau projeté
+template <typename T>
+class Column
+{
+public:
+    Column() = default;
+    Column(const T* data, std::size_t n) : fData(data), fSize(n) {}
+    Column(const std::vector<T>& v) : fData(v.data()), fSize(v.size()) {}
+
+    const T*    data()  const { return fData; }
+    std::size_t size()  const { return fSize; }
+    bool        empty() const { return fSize == 0; }
+    const T*    begin() const { return fData; }
+    const T*    end()   const { return fData + fSize; }
+    const T&    back()  const { return fData[fSize - 1]; }
+    const T&    operator[](std::size_t i) const { return fData[i]; }
+
+private:
+    const T*    fData = nullptr;
+    std::size_t fSize = 0;
+};
+
+/**
+ * Colonnes d'un stockage, sans copie : un ParticleData (conversion
+ * implicite) ou le cache projeté en mémoire (ParticleSource).
+ */
+struct ParticleView {
+    Column<double>       px, py, pz;
+    Column<double>       ws;
+    Column<std::uint8_t> sid;
+    Column<double>       ek;
+    Column<double>       wb;            // vide = 1
+    bool                 energy_sorted = false;
+
+    ParticleView() = default;
+    ParticleView(const ParticleData& d)
+    : px(d.px), py(d.py), pz(d.pz), ws(d.ws), sid(d.sid), ek(d.ek), wb(d.wb)
+    , energy_sorted(d.energy_sorted) {}
+};
+
+/// Espèce à charger : nom dans OpenPMD + nom de la particule Geant4
+struct SpeciesSpec {
+    std::string name;    // ex: "electrons"
+    std::string g4name;  // ex: "e-"
 };
 
+/**
+ * Découpe une liste "electrons,positrons,ions:proton" en espèces.
+ * Sans ":g4name" explicite, la particule Geant4 est déduite du nom
+ * (electrons -> e-, positrons -> e+, protons -> proton, photons -> gamma).
+ * g4name reste vide si rien ne correspond.
+ */
+std::vector<SpeciesSpec> parse_species_list(const std::string& list);
+
 ParticleData read_particle_data_3d(
     const std::string& filename,
     const std::string& species_name,
     int iteration);
 
+/// Charge plusieurs espèces de la même itération dans un seul stockage
+/// (poids cumulés sur l'ensemble, sid[i] = indice dans `species`)
+ParticleData read_particle_data_3d(
+    const std::string& filename,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const Shard& shard = Shard{});
+
+/// Idem depuis une série déjà ouverte (ouverte une seule fois dans main).
+/// shard actif : seule la tranche du shard de chaque espèce est lue.
+ParticleData read_particle_data_3d(
+    openPMD::Series& series,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const Shard& shard = Shard{});
+
+/// Idem depuis une itération déjà ouverte (flux : itération publiée par
+/// l'écrivain, lue une seule fois dans l'ordre)
+ParticleData read_particle_data_3d(
+    openPMD::Iteration& iteration,
+    const std::vector<SpeciesSpec>& species,
+    const Shard& shard = Shard{});
+
 ParticleData read_particle_data_2d(
     const std::string& filename,
     const std::string& species_name,
     int iteration);
 
+/**
+ * Ne garde que les particules d'énergie cinétique > Tcut_MeV.
+ * masses_MeV[k] = masse de l'espèce k (0 pour les photons).
+ * Les poids cumulés sont recalculés sur les particules conservées
+ * et ek reçoit l'énergie cinétique de chaque particule.
+ * Si aucune particule ne passe la coupure, seul ek est rempli.
+ * @return nombre de particules conservées
+ */
+std::size_t filter_kinetic_energy(
+    ParticleData& pdata,
+    const std::vector<double>& masses_MeV,
+    double Tcut_MeV);
+
+/// Indice de la particule tirée (pondérée par ws)
+std::size_t sample_index_3d(
+    const ParticleData& pdata,
+    double rand_0_1);
+
 std::array<double, 3> sample_momentum_3d(
     const ParticleData& pdata,
     double rand_0_1);
@@ -0,0 +1,181 @@
+// src/reorder.cc
+#include "reorder.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace wxg4
+{
+
+namespace
+{
+
+// Clé monotone pour un double >= 0 : son motif binaire IEEE-754
+std::uint64_t energy_key(double T)
+{
+    if (!(T > 0.0)) return 0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &T, sizeof bits);
+    return bits;
+}
+
+// Intercale les bits de x et y (16 bits chacun) -> 32 bits
+std::uint32_t morton2(std::uint32_t x, std::uint32_t y)
+{
+    auto spread = [](std::uint32_t v) {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+// Direction -> carré [-1,1]² par dépliage de l'octaèdre, puis Morton 2D :
+// deux directions voisines ont (presque toujours) des clés voisines.
+std::uint64_t direction_key(double px, double py, double pz)
+{
+    const double n = std::abs(px) + std::abs(py) + std::abs(pz);
+    if (n == 0.0) return 0;
+    double u = px / n;
+    double v = py / n;
+    if (pz < 0.0) {
+        const double uu = (1.0 - std::abs(v)) * (u >= 0.0 ? 1.0 : -1.0);
+        const double vv = (1.0 - std::abs(u)) * (v >= 0.0 ? 1.0 : -1.0);
+        u = uu;
+        v = vv;
+    }
+    auto quantize = [](double a) {
+        const double t = std::clamp(0.5 * (a + 1.0), 0.0, 1.0);
+        return static_cast<std::uint32_t>(t * 65535.0 + 0.5);
+    };
+    return morton2(quantize(u), quantize(v));
+}
+
+// Tri par base LSD (16 bits par passe) de (clé, indice) ; renvoie la permutation.
+// Les passes dont le chiffre est identique pour toutes les clés sont sautées.
+std::vector<std::uint32_t> radix_argsort(const std::vector<std::uint64_t>& keys)
+{
+    const std::size_t N = keys.size();
+    std::vector<std::uint32_t> idx(N), tmp(N);
+    for (std::size_t i = 0; i < N; ++i) idx[i] = static_cast<std::uint32_t>(i);
+
+    std::vector<std::size_t> count(1u << 16);
+    for (int shift = 0; shift < 64; shift += 16) {
+        std::fill(count.begin(), count.end(), 0);
+        for (std::size_t i = 0; i < N; ++i) {
+            ++count[(keys[i] >> shift) & 0xffff];
+        }
+        if (N == 0 || count[(keys[0] >> shift) & 0xffff] == N) continue;
+
+        std::size_t sum = 0;
+        for (auto& c : count) {
+            const std::size_t n = c;
+            c = sum;
+            sum += n;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            const std::uint32_t j = idx[i];
+            tmp[count[(keys[j] >> shift) & 0xffff]++] = j;
+        }
+        idx.swap(tmp);
+    }
+    return idx;
+}
+
+template <typename T>
+void apply_permutation(std::vector<T>& v, const std::vector<std::uint32_t>& perm)
+{
+    if (v.size() != perm.size()) return;
+    std::vector<T> out(v.size());
+    for (std::size_t i = 0; i < perm.size(); ++i) out[i] = v[perm[i]];
+    v.swap(out);
+}
+
+} // namespace
+
+bool parse_sort_key(const std::string& name, SortKey& out)
+{
+    if      (name == "none")      out = SortKey::None;
+    else if (name == "energy")    out = SortKey::Energy;
+    else if (name == "direction") out = SortKey::Direction;
+    else return false;
+    return true;
+}
+
+const char* sort_key_name(SortKey k)
+{
+    switch (k) {
+        case SortKey::None:      return "none";
+        case SortKey::Energy:    return "energy";
+        case SortKey::Direction: return "direction";
+    }
+    return "?";
+}
+
+void sort_particles(ParticleData& pdata, SortKey key)
+{
+    const std::size_t NP = pdata.px.size();
+    if (key == SortKey::None || NP == 0) return;
+
+    std::vector<std::uint64_t> keys(NP);
+    for (std::size_t i = 0; i < NP; ++i) {
+        keys[i] = (key == SortKey::Energy)
+            ? energy_key(pdata.ek[i])
+            : direction_key(pdata.px[i], pdata.py[i], pdata.pz[i]);
+    }
+    const auto perm = radix_argsort(keys);
+
+    // Poids individuels, permutés puis recumulés
+    std::vector<double> w(NP);
+    for (std::size_t i = 0; i < NP; ++i) {
+        w[i] = pdata.ws[i] - (i ? pdata.ws[i - 1] : 0.0);
+    }
+    apply_permutation(w, perm);
+    double wsum = 0.0;
+    for (std::size_t i = 0; i < NP; ++i) {
+        wsum += w[i];
+        pdata.ws[i] = wsum;
+    }
+
+    apply_permutation(pdata.px, perm);
+    apply_permutation(pdata.py, perm);
+    apply_permutation(pdata.pz, perm);
+    apply_permutation(pdata.sid, perm);
+    apply_permutation(pdata.ek, perm);
+    apply_permutation(pdata.wb, perm);
+    pdata.energy_sorted = (key == SortKey::Energy);
+
+    std::cout << "[reorder] " << NP << " particules triées ("
+              << sort_key_name(key) << ")\n";
+}
+
+std::pair<std::size_t, std::size_t> energy_range(
+    const ParticleView& pdata, double Tmin_MeV, double Tmax_MeV)
+{
+    const auto first = std::upper_bound(pdata.ek.begin(), pdata.ek.end(), Tmin_MeV);
+    const auto last  = std::upper_bound(first, pdata.ek.end(), Tmax_MeV);
+    return { static_cast<std::size_t>(first - pdata.ek.begin()),
+             static_cast<std::size_t>(last  - pdata.ek.begin()) };
+}
+
+std::vector<EnergyBand> summarize_energy_bands(
+    const ParticleView& pdata, const std::vector<double>& edges_MeV)
+{
+    std::vector<EnergyBand> bands;
+    if (!pdata.energy_sorted) return bands;
+
+    auto cumw = [&](std::size_t n) { return n ? pdata.ws[n - 1] : 0.0; };
+    for (std::size_t b = 0; b + 1 < edges_MeV.size(); ++b) {
+        const auto r = energy_range(pdata, edges_MeV[b], edges_MeV[b + 1]);
+        bands.push_back({ edges_MeV[b], edges_MeV[b + 1],
+                          r.second - r.first, cumw(r.second) - cumw(r.first) });
+    }
+    return bands;
+}
+
+} // namespace wxg4
@@ -0,0 +1,53 @@
+// src/reorder.hh
+#ifndef REORDER_HH
+#define REORDER_HH
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "read.hh"
+
+namespace wxg4
+{
+
+/// Ordre de rangement du stockage après filtrage
+enum class SortKey {
+    None,       // ordre du fichier WarpX
+    Energy,     // énergie cinétique croissante
+    Direction   // clé de Morton de la direction (octaèdre déplié)
+};
+
+/// "none" | "energy" | "direction" ; renvoie false si inconnu
+bool parse_sort_key(const std::string& name, SortKey& out);
+const char* sort_key_name(SortKey k);
+
+/**
+ * Réordonne px, py, pz, sid, ek, wb et les poids (tri par base, stable).
+ * Les poids cumulés sont recalculés dans le nouvel ordre.
+ * Nécessite ek rempli (filter_kinetic_energy).
+ */
+void sort_particles(ParticleData& pdata, SortKey key);
+
+/**
+ * Intervalle [first, last) des particules avec Tmin < T <= Tmax
+ * (recherche dichotomique, stockage trié par énergie uniquement).
+ */
+std::pair<std::size_t, std::size_t> energy_range(
+    const ParticleView& pdata, double Tmin_MeV, double Tmax_MeV);
+
+/// Résumé d'une bande d'énergie ]Tmin, Tmax]
+struct EnergyBand {
+    double      Tmin, Tmax;  // MeV
+    std::size_t count;       // nombre de macroparticules
+    double      weight;      // somme des poids
+};
+
+/// Résumé par bandes (edges croissants), sans re-tri : stockage trié par énergie
+std::vector<EnergyBand> summarize_energy_bands(
+    const ParticleView& pdata, const std::vector<double>& edges_MeV);
+
+} // namespace wxg4
+
+#endif // REORDER_HH
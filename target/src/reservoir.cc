@@ -0,0 +1,244 @@
+// src/reservoir.cc
+#include "reservoir.hh"
+
+#include <openPMD/openPMD.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace wxg4
+{
+
+namespace
+{
+
+/// Tirage dans ]0, 1]
+double uniform_open0(std::mt19937_64& gen)
+{
+    return 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+}
+
+} // namespace
+
+WeightedReservoir::WeightedReservoir(std::size_t k, std::uint64_t seed)
+: fCapacity(k + 1)
+, fGen(seed)
+{
+    fHeap.reserve(fCapacity);
+}
+
+std::size_t WeightedReservoir::Size() const
+{
+    return fHeap.size() == fCapacity ? fCapacity - 1 : fHeap.size();
+}
+
+void WeightedReservoir::Push(const Item& item)
+{
+    // Tas min : la plus petite clé (le seuil) en tête
+    const auto greater = [](const Item& a, const Item& b) { return a.key > b.key; };
+    if (fHeap.size() == fCapacity) {
+        std::pop_heap(fHeap.begin(), fHeap.end(), greater);
+        fHeap.back() = item;
+    } else {
+        fHeap.push_back(item);
+    }
+    std::push_heap(fHeap.begin(), fHeap.end(), greater);
+}
+
+void WeightedReservoir::Rearm()
+{
+    // Poids à parcourir avant qu'une clé ne dépasse le seuil L : ln(r) / L
+    const double L = fHeap.front().key;
+    fSkip = (L < 0.) ? std::log(uniform_open0(fGen)) / L
+                     : std::numeric_limits<double>::infinity();
+}
+
+void WeightedReservoir::Add(double px, double py, double pz, double w, double ek, std::uint8_t sid)
+{
+    ++fSeen;
+    if (!(w > 0.)) return;
+    fSeenWeight += w;
+
+    // Remplissage : clé tirée pour chaque particule
+    if (fHeap.size() < fCapacity) {
+        Push({std::log(uniform_open0(fGen)) / w, px, py, pz, w, ek, sid});
+        if (fHeap.size() == fCapacity) Rearm();
+        return;
+    }
+
+    // Saut exponentiel : seule la particule qui franchit le saut est tirée,
+    // avec une clé conditionnée à dépasser le seuil (u dans ]exp(L w), 1])
+    fSkip -= w;
+    if (fSkip > 0.) return;
+    const double t = std::exp(fHeap.front().key * w);
+    const double u = t + (1.0 - t) * uniform_open0(fGen);
+    Push({std::log(u) / w, px, py, pz, w, ek, sid});
+    Rearm();
+}
+
+void WeightedReservoir::Merge(const WeightedReservoir& other)
+{
+    for (const Item& item : other.fHeap) {
+        if (fHeap.size() < fCapacity || item.key > fHeap.front().key) Push(item);
+    }
+    fSeen       += other.fSeen;
+    fSeenWeight += other.fSeenWeight;
+    if (fHeap.size() == fCapacity) Rearm();
+}
+
+ParticleData WeightedReservoir::Extract()
+{
+    ParticleData pdata;
+    std::vector<Item> items = fHeap;
+    if (items.empty()) return pdata;
+
+    // Seuil τ = clé k+1 (écartée) ; flux plus court que k+1 : tout est gardé
+    double tau = -std::numeric_limits<double>::infinity();
+    if (items.size() == fCapacity) {
+        const auto threshold = std::min_element(items.begin(), items.end(),
+            [](const Item& a, const Item& b) { return a.key < b.key; });
+        tau = threshold->key;
+        items.erase(threshold);
+    }
+    std::shuffle(items.begin(), items.end(), fGen);
+
+    const std::size_t n = items.size();
+    pdata.px.reserve(n);
+    pdata.py.reserve(n);
+    pdata.pz.reserve(n);
+    pdata.ek.reserve(n);
+    pdata.sid.reserve(n);
+    pdata.ws.reserve(n);
+    pdata.wb.reserve(n);
+    double total = 0.0;
+    for (const Item& item : items) {
+        const double pi = -std::expm1(item.w * tau);   // probabilité d'inclusion
+        const double ht = item.w / pi;
+        total += ht;
+        pdata.px.push_back(item.px);
+        pdata.py.push_back(item.py);
+        pdata.pz.push_back(item.pz);
+        pdata.ek.push_back(item.ek);
+        pdata.sid.push_back(item.sid);
+        pdata.ws.push_back(total);
+        pdata.wb.push_back(ht);
+    }
+    const double mean = total / static_cast<double>(n);
+    for (double& wb : pdata.wb) wb /= mean;
+    return pdata;
+}
+
+ParticleData reservoir_sample_3d(
+    openPMD::Iteration& it,
+    const std::vector<SpeciesSpec>& species,
+    const ReservoirParams& params,
+    const Shard& shard)
+{
+    // 1) Taille de l'échantillon : extents des tranches, sans lire de données
+    std::vector<std::uint64_t> first(species.size(), 0), count(species.size(), 0);
+    std::uint64_t records = 0;
+    for (std::size_t s = 0; s < species.size(); ++s) {
+        const std::uint64_t extent =
+            it.particles[species[s].name]["momentum"]["x"].getExtent()[0];
+        count[s] = extent;
+        if (shard.Active()) shard_range(extent, shard, first[s], count[s]);
+        records += count[s];
+    }
+    if (records == 0) return ParticleData{};
+    std::uint64_t k = static_cast<std::uint64_t>(
+        std::ceil(params.fraction * static_cast<double>(records)));
+    k = std::clamp<std::uint64_t>(k, 1, records);
+
+    // 2) Un réservoir par thread, flux aléatoires distincts
+    const unsigned nt = std::max(1u, params.threads);
+    std::random_device rd;
+    std::vector<WeightedReservoir> reservoirs;
+    reservoirs.reserve(nt);
+    for (unsigned t = 0; t < nt; ++t) {
+        const std::uint64_t seed = params.seed
+            ? stream_seed(params.seed, t + 1)
+            : (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+        reservoirs.emplace_back(static_cast<std::size_t>(k), seed);
+    }
+    std::cout << "[reservoir] " << records << " enregistrements, échantillon de " << k
+              << " (" << nt << " réservoir(s), blocs de " << params.chunk << ")" << std::endl;
+
+    // 3) Lecture par blocs ; chaque bloc filtré et réparti entre les threads
+    for (std::size_t s = 0; s < species.size(); ++s) {
+        auto sp = it.particles[species[s].name];
+        const double mass = params.masses_MeV[s];
+        const auto sid = static_cast<std::uint8_t>(s);
+        for (std::uint64_t done = 0; done < count[s]; done += params.chunk) {
+            const std::uint64_t n = std::min<std::uint64_t>(params.chunk, count[s] - done);
+            const openPMD::Offset offset{first[s] + done};
+            const openPMD::Extent extent{n};
+            auto px = sp["momentum"]["x"].loadChunk<double>(offset, extent);
+            auto py = sp["momentum"]["y"].loadChunk<double>(offset, extent);
+            auto pz = sp["momentum"]["z"].loadChunk<double>(offset, extent);
+            auto w  = sp["weighting"].loadChunk<double>(offset, extent);
+            it.seriesFlush();
+
+            const auto consume = [&](std::uint64_t a, std::uint64_t b, WeightedReservoir& res) {
+                const double* vx = px.get();
+                const double* vy = py.get();
+                const double* vz = pz.get();
+                const double* vw = w.get();
+                for (std::uint64_t i = a; i < b; ++i) {
+                    const double x = vx[i] / MEV_C_CONVERSION;   // MeV/c
+                    const double y = vy[i] / MEV_C_CONVERSION;
+                    const double z = vz[i] / MEV_C_CONVERSION;
+                    const double T = std::sqrt(x*x + y*y + z*z + mass*mass) - mass;
+                    if (!(T > params.Tcut_MeV)) {
+                        res.Add(0., 0., 0., 0., T, sid);   // compté, jamais retenu
+                        continue;
+                    }
+                    res.Add(vx[i], vy[i], vz[i], vw[i], T, sid);
+                }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned t = 1; t < nt; ++t) {
+                workers.emplace_back(consume, n * t / nt, n * (t + 1) / nt, std::ref(reservoirs[t]));
+            }
+            consume(0, n / nt, reservoirs[0]);
+            for (auto& worker : workers) worker.join();
+        }
+        std::cout << "[reservoir] " << species[s].name << " : " << count[s]
+                  << " particules parcourues" << std::endl;
+    }
+
+    // 4) Fusion des réservoirs, échantillon final
+    for (unsigned t = 1; t < nt; ++t) reservoirs[0].Merge(reservoirs[t]);
+    ParticleData pdata = reservoirs[0].Extract();
+    std::cout << "[reservoir] " << pdata.px.size() << " particules retenues (T > "
+              << params.Tcut_MeV << " MeV), poids filtré " << reservoirs[0].SeenWeight()
+              << ", estimé " << (pdata.ws.empty() ? 0. : pdata.ws.back()) << std::endl;
+    return pdata;
+}
+
+ParticleData reservoir_sample_3d(
+    openPMD::Series& series,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const ReservoirParams& params,
+    const Shard& shard)
+{
+    auto it = series.iterations[iteration];
+    it.open();
+    return reservoir_sample_3d(it, species, params, shard);
+}
+
+ParticleData reservoir_sample_3d(
+    const std::string& filename,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const ReservoirParams& params,
+    const Shard& shard)
+{
+    openPMD::Series series(filename, openPMD::Access::READ_ONLY, OPENPMD_READ_OPTIONS);
+    return reservoir_sample_3d(series, species, iteration, params, shard);
+}
+
+} // namespace wxg4
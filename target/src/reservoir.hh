@@ -0,0 +1,106 @@
+// src/reservoir.hh
+#ifndef RESERVOIR_HH
+#define RESERVOIR_HH
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+
+namespace openPMD { class Series; class Iteration; }
+
+namespace wxg4
+{
+
+/**
+ * Échantillon pondéré sans remise en une passe (Efraimidis–Spirakis,
+ * variante A-ExpJ) : chaque particule reçoit la clé ln(u)/w et les k plus
+ * grandes clés sont gardées dans un tas. Une fois le tas plein, un saut
+ * exponentiel donne directement le poids à parcourir avant la prochaine
+ * insertion : O(k log(n/k)) tirages au lieu de n. Mémoire en O(k).
+ *
+ * Les clés étant indépendantes, deux réservoirs sur des flux disjoints se
+ * fusionnent en gardant les k meilleures clés de leur réunion (threads,
+ * tranches, rangs MPI).
+ */
+class WeightedReservoir
+{
+public:
+    /// k : taille de l'échantillon (une clé de plus est gardée comme seuil)
+    WeightedReservoir(std::size_t k, std::uint64_t seed);
+
+    /// Particule du flux ; w <= 0 : jamais retenue
+    void Add(double px, double py, double pz, double w, double ek, std::uint8_t sid);
+    /// Réunion avec un réservoir sur un flux disjoint
+    void Merge(const WeightedReservoir& other);
+
+    std::uint64_t Seen()       const { return fSeen; }
+    double        SeenWeight() const { return fSeenWeight; }
+    std::size_t   Size()       const;
+
+    /**
+     * Échantillon final, dans un ordre aléatoire. Le seuil τ (clé k+1)
+     * donne la probabilité d'inclusion π = 1 - exp(w τ) de chaque
+     * particule : ws cumule les poids w/π (Horvitz–Thompson, somme = poids
+     * total estimé) et wb = (w/π) / moyenne, chaque particule simulée une
+     * fois portant la part de poids qu'elle représente.
+     */
+    ParticleData Extract();
+
+private:
+    struct Item {
+        double       key;   // ln(u) / w, <= 0
+        double       px, py, pz, w, ek;
+        std::uint8_t sid;
+    };
+    void Push(const Item& item);
+    void Rearm();
+
+    std::size_t         fCapacity;    // k + 1
+    std::vector<Item>   fHeap;        // tas min sur key
+    std::mt19937_64     fGen;
+    double              fSkip = 0.;   // poids restant avant la prochaine insertion
+    std::uint64_t       fSeen = 0;
+    double              fSeenWeight = 0.;
+};
+
+/// Paramètres de la lecture par blocs
+struct ReservoirParams {
+    std::vector<double> masses_MeV;           // par espèce, pour le filtre
+    double              Tcut_MeV  = 50.0;     // filtre T > Tcut appliqué au vol
+    double              fraction  = 0.1;      // k = ceil(fraction x enregistrements)
+    std::uint64_t       seed      = 0;        // 0 = graine aléatoire
+    unsigned            threads   = 1;        // un réservoir par thread, fusionnés
+    std::uint64_t       chunk     = 1u << 22; // enregistrements lus par bloc et par espèce
+};
+
+/**
+ * Lecture par blocs d'une itération (tranche du shard) sans garder les
+ * particules : filtre en énergie et réservoir au vol. k est déduit des
+ * extents (métadonnées), connus avant toute lecture de données.
+ */
+ParticleData reservoir_sample_3d(
+    openPMD::Iteration& iteration,
+    const std::vector<SpeciesSpec>& species,
+    const ReservoirParams& params,
+    const Shard& shard = Shard{});
+
+ParticleData reservoir_sample_3d(
+    openPMD::Series& series,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const ReservoirParams& params,
+    const Shard& shard = Shard{});
+
+ParticleData reservoir_sample_3d(
+    const std::string& filename,
+    const std::vector<SpeciesSpec>& species,
+    int iteration,
+    const ReservoirParams& params,
+    const Shard& shard = Shard{});
+
+} // namespace wxg4
+
+#endif // RESERVOIR_HH
@@ -0,0 +1,340 @@
+// src/response.cc
+#include "response.hh"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace wxg4
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'W', 'X', 'G', '4', 'R', 'S', 'P', '1'};
+
+std::mutex     gMutex;
+ResponseMatrix gTotal;
+bool           gHasTotal = false;
+
+std::vector<double> linear_edges(const BinSpec& s)
+{
+    std::vector<double> e(s.n + 1);
+    for (unsigned i = 0; i <= s.n; ++i) e[i] = s.lo + (s.hi - s.lo) * i / s.n;
+    return e;
+}
+
+std::vector<double> log_edges(const BinSpec& s)
+{
+    std::vector<double> e(s.n + 1);
+    const double r = std::log(s.hi / s.lo);
+    for (unsigned i = 0; i <= s.n; ++i) e[i] = s.lo * std::exp(r * i / s.n);
+    e.back() = s.hi;
+    return e;
+}
+
+/// Indice du bin contenant x ; -1 dessous, n dessus
+long locate(const std::vector<double>& edges, double x)
+{
+    if (x < edges.front()) return -1;
+    if (x >= edges.back()) return static_cast<long>(edges.size() - 1);
+    return static_cast<long>(std::upper_bound(edges.begin(), edges.end(), x) - edges.begin()) - 1;
+}
+
+std::size_t clamp_bin(const std::vector<double>& edges, double x)
+{
+    const long i = locate(edges, x);
+    const long n = static_cast<long>(edges.size()) - 2;
+    return static_cast<std::size_t>(std::clamp(i, 0L, n));
+}
+
+template <class T>
+void write_pod(std::ostream& out, const T& v)
+{
+    out.write(reinterpret_cast<const char*>(&v), sizeof v);
+}
+
+template <class T>
+void read_pod(std::istream& in, T& v)
+{
+    in.read(reinterpret_cast<char*>(&v), sizeof v);
+}
+
+void write_array(std::ostream& out, const std::vector<double>& v)
+{
+    out.write(reinterpret_cast<const char*>(v.data()),
+              static_cast<std::streamsize>(v.size() * sizeof(double)));
+}
+
+void read_array(std::istream& in, std::vector<double>& v, std::size_t n)
+{
+    v.resize(n);
+    in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(n * sizeof(double)));
+}
+
+} // namespace
+
+bool parse_bin_spec(const std::string& text, BinSpec& out)
+{
+    std::istringstream is(text);
+    char c1 = 0, c2 = 0;
+    BinSpec s;
+    long n = 0;
+    if (!(is >> s.lo >> c1 >> s.hi >> c2 >> n) || c1 != ':' || c2 != ':') return false;
+    if (n < 1 || !(s.lo < s.hi)) return false;
+    s.n = static_cast<unsigned>(n);
+    out = s;
+    return true;
+}
+
+HitClass hit_class(int pdg)
+{
+    switch (pdg) {
+        case 22:  return HitClass::Gamma;
+        case 11:  return HitClass::Electron;
+        case -11: return HitClass::Positron;
+        default:  return HitClass::Other;
+    }
+}
+
+const char* hit_class_name(HitClass c)
+{
+    switch (c) {
+        case HitClass::Gamma:    return "gamma";
+        case HitClass::Electron: return "e-";
+        case HitClass::Positron: return "e+";
+        default:                 return "other";
+    }
+}
+
+ResponseBinning ResponseBinning::Make(const BinSpec& energy, const BinSpec& theta,
+                                      const BinSpec& radius, const BinSpec& eout)
+{
+    ResponseBinning b;
+    b.energy = log_edges(energy);
+    b.theta  = linear_edges(theta);
+    b.radius = linear_edges(radius);
+    b.eout   = log_edges(eout);
+    return b;
+}
+
+std::size_t ResponseBinning::NOut() const
+{
+    return static_cast<std::size_t>(HitClass::kCount) * (radius.size() - 1) * (eout.size() - 1);
+}
+
+long ResponseBinning::InputBin(double ek_MeV, double theta_deg) const
+{
+    const long ie = locate(energy, ek_MeV);
+    const long it = locate(theta, theta_deg);
+    if (ie < 0 || it < 0 || ie >= static_cast<long>(NEnergy()) || it >= static_cast<long>(NTheta())) {
+        return -1;
+    }
+    return ie * static_cast<long>(NTheta()) + it;
+}
+
+std::size_t ResponseBinning::OutputBin(HitClass c, double r_mm, double ek_MeV) const
+{
+    const std::size_t nr = radius.size() - 1;
+    const std::size_t ne = eout.size() - 1;
+    return (static_cast<std::size_t>(c) * nr + clamp_bin(radius, r_mm)) * ne + clamp_bin(eout, ek_MeV);
+}
+
+ResponseMatrix::ResponseMatrix(const ResponseBinning& bins, const std::string& particle, double mass_MeV)
+: fBins(bins)
+, fParticle(particle)
+, fMass(mass_MeV)
+, fNOut(bins.NOut())
+, fPrimaries(bins.NIn(), 0.)
+, fCounts(bins.NIn() * bins.NOut(), 0.)
+{}
+
+double ResponseMatrix::Response(std::size_t in, std::size_t out) const
+{
+    return fPrimaries[in] > 0. ? fCounts[in * fNOut + out] / fPrimaries[in] : 0.;
+}
+
+void ResponseMatrix::Merge(const ResponseMatrix& other)
+{
+    for (std::size_t i = 0; i < fPrimaries.size(); ++i) fPrimaries[i] += other.fPrimaries[i];
+    for (std::size_t i = 0; i < fCounts.size(); ++i)    fCounts[i]    += other.fCounts[i];
+}
+
+void ResponseMatrix::Flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        if (!gHasTotal) {
+            gTotal = *this;
+            gHasTotal = true;
+        } else {
+            gTotal.Merge(*this);
+        }
+    }
+    std::fill(fPrimaries.begin(), fPrimaries.end(), 0.);
+    std::fill(fCounts.begin(), fCounts.end(), 0.);
+}
+
+bool ResponseMatrix::SaveTotal(const std::string& path, std::string& err)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (!gHasTotal) {
+        err = "empty response matrix";
+        return false;
+    }
+    const bool ok = gTotal.Save(path, err);
+    gTotal = ResponseMatrix{};
+    gHasTotal = false;
+    return ok;
+}
+
+bool ResponseMatrix::Save(const std::string& path, std::string& err) const
+{
+    std::error_code ec;
+    const fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+    const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            err = "cannot create " + tmp;
+            return false;
+        }
+        out.write(kMagic, sizeof kMagic);
+        const std::uint32_t sizes[5] = {
+            static_cast<std::uint32_t>(fBins.energy.size()),
+            static_cast<std::uint32_t>(fBins.theta.size()),
+            static_cast<std::uint32_t>(fBins.radius.size()),
+            static_cast<std::uint32_t>(fBins.eout.size()),
+            static_cast<std::uint32_t>(fParticle.size())
+        };
+        for (const auto s : sizes) write_pod(out, s);
+        write_pod(out, fMass);
+        out.write(fParticle.data(), static_cast<std::streamsize>(fParticle.size()));
+        write_array(out, fBins.energy);
+        write_array(out, fBins.theta);
+        write_array(out, fBins.radius);
+        write_array(out, fBins.eout);
+        write_array(out, fPrimaries);
+        write_array(out, fCounts);
+        if (!out) {
+            err = "write error on " + tmp;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        err = "cannot rename " + tmp + ": " + ec.message();
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool ResponseMatrix::Load(const std::string& path, std::string& err)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        err = "cannot open " + path;
+        return false;
+    }
+    char magic[sizeof kMagic];
+    in.read(magic, sizeof magic);
+    if (!in || std::memcmp(magic, kMagic, sizeof kMagic) != 0) {
+        err = path + " is not a response matrix";
+        return false;
+    }
+    std::uint32_t sizes[5];
+    for (auto& s : sizes) read_pod(in, s);
+    if (!in || sizes[0] < 2 || sizes[1] < 2 || sizes[2] < 2 || sizes[3] < 2) {
+        err = "corrupt header in " + path;
+        return false;
+    }
+
+    ResponseMatrix m;
+    read_pod(in, m.fMass);
+    m.fParticle.resize(sizes[4]);
+    in.read(m.fParticle.data(), static_cast<std::streamsize>(sizes[4]));
+    read_array(in, m.fBins.energy, sizes[0]);
+    read_array(in, m.fBins.theta,  sizes[1]);
+    read_array(in, m.fBins.radius, sizes[2]);
+    read_array(in, m.fBins.eout,   sizes[3]);
+    m.fNOut = m.fBins.NOut();
+    read_array(in, m.fPrimaries, m.fBins.NIn());
+    read_array(in, m.fCounts, m.fBins.NIn() * m.fNOut);
+    if (!in) {
+        err = "truncated response matrix " + path;
+        return false;
+    }
+    *this = std::move(m);
+    return true;
+}
+
+ResponseMatrix::Folded ResponseMatrix::Fold(const ParticleData& pdata) const
+{
+    constexpr double kRadToDeg = 180.0 / 3.14159265358979323846;
+
+    // 1) Spectre d'entrée : poids par bin (énergie, angle)
+    const std::size_t nIn = fBins.NIn();
+    std::vector<double> spectrum(nIn, 0.);
+    Folded f;
+    double prev = 0.;
+    for (std::size_t i = 0; i < pdata.px.size(); ++i) {
+        const double w = pdata.ws[i] - prev;   // ws : poids cumulés
+        prev = pdata.ws[i];
+
+        const double p = std::sqrt(pdata.px[i] * pdata.px[i] + pdata.py[i] * pdata.py[i]
+                                   + pdata.pz[i] * pdata.pz[i]);
+        const double theta = p > 0. ? std::acos(pdata.pz[i] / p) * kRadToDeg : 0.;
+        const long in = fBins.InputBin(pdata.ek[i], theta);
+        if (in >= 0) {
+            spectrum[static_cast<std::size_t>(in)] += w;
+            f.inside += w;
+        } else if (pdata.ek[i] < fBins.energy.front()) {
+            f.underflow += w;
+        } else {
+            f.overflow += w;
+        }
+    }
+
+    // 2) Produit par la réponse normalisée (hits par primaire)
+    f.hits.assign(fNOut, 0.);
+    for (std::size_t in = 0; in < nIn; ++in) {
+        if (spectrum[in] == 0. || fPrimaries[in] == 0.) continue;
+        const double scale = spectrum[in] / fPrimaries[in];
+        const double* row = fCounts.data() + in * fNOut;
+        for (std::size_t out = 0; out < fNOut; ++out) f.hits[out] += scale * row[out];
+    }
+    return f;
+}
+
+void ResponseMatrix::WriteCsv(std::ostream& os, const ResponseBinning& bins,
+                              const std::vector<double>& hits)
+{
+    const std::size_t nr = bins.radius.size() - 1;
+    const std::size_t ne = bins.eout.size() - 1;
+    os << "class,r_lo_mm,r_hi_mm,E_lo_MeV,E_hi_MeV,hits\n";
+    for (std::size_t c = 0; c < static_cast<std::size_t>(HitClass::kCount); ++c) {
+        for (std::size_t ir = 0; ir < nr; ++ir) {
+            for (std::size_t ie = 0; ie < ne; ++ie) {
+                const double h = hits[(c * nr + ir) * ne + ie];
+                if (h == 0.) continue;
+                os << hit_class_name(static_cast<HitClass>(c)) << ','
+                   << bins.radius[ir] << ',' << bins.radius[ir + 1] << ','
+                   << bins.eout[ie] << ',' << bins.eout[ie + 1] << ',' << h << '\n';
+            }
+        }
+    }
+}
+
+} // namespace wxg4
@@ -0,0 +1,125 @@
+// src/response.hh
+#ifndef RESPONSE_HH
+#define RESPONSE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+
+namespace wxg4
+{
+
+/// Axe régulier "lo:hi:n" (échelle log pour les énergies)
+struct BinSpec {
+    double   lo = 0.;
+    double   hi = 0.;
+    unsigned n  = 0;
+};
+
+/// Lit "lo:hi:n" (n >= 1, lo < hi) ; false si invalide
+bool parse_bin_spec(const std::string& text, BinSpec& out);
+
+/// Famille du hit sur les pixels (premier axe de sortie)
+enum class HitClass : std::uint8_t { Gamma, Electron, Positron, Other, kCount };
+
+HitClass    hit_class(int pdg);
+const char* hit_class_name(HitClass c);
+
+/**
+ * Axes de la matrice de réponse.
+ * Entrée  : énergie cinétique du primaire (log) x angle polaire / +z.
+ * Sortie  : famille du hit x rayon sur le plan des pixels x énergie
+ *           cinétique du hit (log) ; hors bornes ramené au bin extrême.
+ */
+struct ResponseBinning {
+    std::vector<double> energy;   // bords [MeV]
+    std::vector<double> theta;    // bords [deg]
+    std::vector<double> radius;   // bords [mm]
+    std::vector<double> eout;     // bords [MeV]
+
+    static ResponseBinning Make(const BinSpec& energy, const BinSpec& theta,
+                                const BinSpec& radius, const BinSpec& eout);
+
+    std::size_t NEnergy() const { return energy.size() - 1; }
+    std::size_t NTheta()  const { return theta.size() - 1; }
+    std::size_t NIn()     const { return NEnergy() * NTheta(); }
+    std::size_t NOut()    const;
+
+    /// Bin d'entrée (énergie majeure, angle mineur) ; -1 hors domaine
+    long InputBin(double ek_MeV, double theta_deg) const;
+    std::size_t OutputBin(HitClass c, double r_mm, double ek_MeV) const;
+
+    /// Mode réponse : les événements d'un bin d'entrée sont consécutifs
+    static std::size_t EventBin(long eventID, std::uint64_t perBin, std::size_t nIn)
+    {
+        return static_cast<std::size_t>(static_cast<std::uint64_t>(eventID) / perBin) % nIn;
+    }
+};
+
+/**
+ * Réponse du détecteur : poids des hits par (bin d'entrée, bin de sortie)
+ * et nombre de primaires simulés par bin d'entrée. Rempli par une
+ * instance par thread (MyEventAction) ; Flush() la verse dans le total
+ * commun, écrit en fin de run par SaveTotal().
+ */
+class ResponseMatrix
+{
+public:
+    ResponseMatrix() = default;
+    ResponseMatrix(const ResponseBinning& bins, const std::string& particle, double mass_MeV);
+
+    void AddPrimary(std::size_t in) { fPrimaries[in] += 1.0; }
+    void AddHit(std::size_t in, std::size_t out, double w) { fCounts[in * fNOut + out] += w; }
+
+    /// Hits par primaire du bin d'entrée in
+    double Response(std::size_t in, std::size_t out) const;
+
+    const ResponseBinning& Binning()  const { return fBins; }
+    const std::string&     Particle() const { return fParticle; }
+    double                 Mass()     const { return fMass; }
+    double                 Primaries(std::size_t in) const { return fPrimaries[in]; }
+
+    /// Ajoute cette matrice au total commun, puis la vide
+    void Flush();
+    /// Écrit le total commun (fichier temporaire puis renommage) et le vide
+    static bool SaveTotal(const std::string& path, std::string& err);
+
+    bool Save(const std::string& path, std::string& err) const;
+    bool Load(const std::string& path, std::string& err);
+
+    struct Folded {
+        std::vector<double> hits;       // hits attendus par bin de sortie
+        double              inside    = 0.;   // poids des particules pliées
+        double              underflow = 0.;   // poids sous l'énergie minimale
+        double              overflow  = 0.;   // poids au-delà (énergie ou angle)
+    };
+
+    /**
+     * Plie un jeu de particules : chacune tombe dans un bin d'entrée et
+     * apporte poids x réponse du bin. pdata.ek doit être rempli avec la
+     * masse de la particule de la matrice (filter_kinetic_energy).
+     */
+    Folded Fold(const ParticleData& pdata) const;
+
+    /// Lignes non nulles : classe, rayon, énergie, hits
+    static void WriteCsv(std::ostream& os, const ResponseBinning& bins,
+                         const std::vector<double>& hits);
+
+private:
+    void Merge(const ResponseMatrix& other);
+
+    ResponseBinning     fBins;
+    std::string         fParticle;
+    double              fMass = 0.;
+    std::size_t         fNOut = 0;
+    std::vector<double> fPrimaries;   // NIn
+    std::vector<double> fCounts;      // NIn x NOut
+};
+
+} // namespace wxg4
+
+#endif // RESPONSE_HH
@@ -1,64 +1,243 @@
 // src/run.cc
 #include "run.hh"
 #include "G4AnalysisManager.hh"
+#include "G4Threading.hh"
+#include "profiler.hh"
+#include "volumes.hh"
+#include "response.hh"
+#include "kernel.hh"
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 
-MyRunAction::MyRunAction()
-{}
+MyRunAction::MyRunAction(const std::string& label, const std::string& profilePath)
+: fLabel(label)
+, fProfilePath(profilePath)
+{
+    // Multithread : un seul fichier, fusionné par le maître
+    if (G4Threading::IsMultithreadedApplication()) {
+        G4AnalysisManager::Instance()->SetNtupleMerging(true);
+    }
+}
 
 MyRunAction::~MyRunAction()
 {}
 
+void MyRunAction::SetCheckpoint(const std::string& dir, unsigned every, unsigned generation)
+{
+    fCheckpointDir   = dir;
+    fCheckpointEvery = every ? every : 1;
+    fGeneration      = generation;
+}
+
+void MyRunAction::SetResume(std::vector<std::uint64_t> events, std::vector<wxg4::JournalRow> rows)
+{
+    fEventMap = std::move(events);
+    fReplay   = std::move(rows);
+    fReplayTaken = false;
+}
+
 void MyRunAction::BeginOfRunAction(const G4Run*)
 {
-    // 1. On voit d’abord où on se trouve
-    std::cout << "[DEBUG RunAction] cwd = "
-              << std::filesystem::current_path() << "\n";
+    fHitRows.clear();
+    fPendingEvents = 0;
+    fRunStart     = std::chrono::steady_clock::now();
+    if (IsMaster()) wxg4::Profiler::Instance().ResetRun();
 
-    // 2. Est-ce que le fichier existait déjà ?
-    std::cout << "[DEBUG RunAction] Avant OpenFile, output.root existe ? "
-              << std::boolalpha
-              << std::filesystem::exists("output.root") << "\n";
+    const std::string file = OutputFile();
 
     auto* man = G4AnalysisManager::Instance();
-    std::cout << "[DEBUG RunAction] Instance d’analyse @ " << man << "\n";
-
-    // 3. On ouvre le fichier
-    std::cout << "[DEBUG RunAction] -> OpenFile(\"output.root\")\n";
-    man->OpenFile("output.root");
-
-    // 5. Et que le système de fichiers voit bien la création
-    std::cout << "[DEBUG RunAction] Après OpenFile, output.root existe ? "
-              << std::filesystem::exists("output.root") << "\n";
-
-    // Création du ntuple "momenta"
-    man->CreateNtuple("momenta", "Particle Momenta");
-    man->CreateNtupleIColumn("eventID");  // colonne 0
-    man->CreateNtupleDColumn("px");       // colonne 1
-    man->CreateNtupleDColumn("py");       // colonne 2
-    man->CreateNtupleDColumn("pz");       // colonne 3
-    man->FinishNtuple(0);                 // termine le ntuple d’indice 0
-    std::cout << "[RunAction] Ntuple 'momenta' créé\n";
+    man->OpenFile(file);
+
+    // Création du ntuple "momenta", une seule fois : les runs suivants
+    // (balayage, run.mac) réutilisent la même réservation
+    if (!fNtupleBooked) {
+        fNtupleBooked = true;
+        man->CreateNtuple("momenta", "Particle Momenta");
+        man->CreateNtupleIColumn("eventID");  // colonne 0
+        man->CreateNtupleDColumn("px");       // colonne 1
+        man->CreateNtupleDColumn("py");       // colonne 2
+        man->CreateNtupleDColumn("pz");       // colonne 3
+        man->CreateNtupleDColumn("weight");   // colonne 4 : poids statistique
+        man->FinishNtuple(0);                 // termine le ntuple d’indice 0
+        std::cout << "[RunAction] Ntuple 'momenta' créé\n";
+    }
+
+    // Points de reprise : les threads qui simulent (le seul en séquentiel)
+    // journalisent leurs événements ; le premier arrivé rejoue les hits
+    // des journaux précédents dans son ntuple
+    const bool simulates = !(G4Threading::IsMultithreadedApplication() && IsMaster());
+    if (fCheckpointDir.empty() || !simulates) return;
+    if (!fReplay.empty() && !fReplayTaken.exchange(true)) {
+        fHitRows.assign(fReplay.begin(), fReplay.end());
+        FlushHits();
+        std::cout << "[RunAction] Reprise : " << fReplay.size() << " hits rejoués\n";
+    }
+    const wxg4::Checkpoint checkpoint(fCheckpointDir, file);
+    const int thread = std::max(0, G4Threading::G4GetThreadId());
+    fJournal = std::make_unique<wxg4::CheckpointJournal>();
+    if (!fJournal->Open(checkpoint.JournalPath(fGeneration, thread))) {
+        std::cerr << "[RunAction] Journal de reprise impossible à créer dans "
+                  << fCheckpointDir << "\n";
+        fJournal.reset();
+    }
+    fSinceSync = 0;
 }
 
 void MyRunAction::EndOfRunAction(const G4Run*)
 {
+    // Durée de la boucle d'événements, avant l'écriture du fichier
+    const std::chrono::duration<double> runTime =
+        std::chrono::steady_clock::now() - fRunStart;
+    auto& prof = wxg4::Profiler::Instance();
+    if (IsMaster()) prof.AddTime(wxg4::Stage::EventLoop, runTime.count());
+    const std::string file = OutputFile();
+
+    // Hits des derniers événements, pas encore versés ; journal synchronisé
+    FlushHits();
+    fJournal.reset();
+
+    // Écriture et fermeture du fichier
     auto* man = G4AnalysisManager::Instance();
-    std::cout << "[DEBUG RunAction] Instance d’analyse @ " << man << "\n";
+    {
+        wxg4::ScopeTimer timer(wxg4::Stage::Output);
+        man->Write();
+        man->CloseFile();
+    }
+
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(file, ec);
+    if (!ec && IsMaster()) prof.Add(wxg4::Counter::OutputBytes, bytes);
+
+    // Sortie complète : les points de reprise de ce run ne servent plus
+    if (!fCheckpointDir.empty() && IsMaster() && !ec) {
+        wxg4::Checkpoint(fCheckpointDir, file).Remove();
+        std::cout << "[RunAction] Points de reprise de " << file << " supprimés\n";
+    }
+
+    // Profil du run : temps par étape et compteurs, puis par volume.
+    // Les threads de travail versent leur table ; le maître, qui termine
+    // après eux, écrit le total.
+    if (fVolumes) fVolumes->Flush();
+    if (fResponse) fResponse->Flush();
+    if (fKernel) fKernel->Flush();
+    if (!IsMaster()) return;
+
+    // Débit et temps par événement, sommés sur les threads
+    const std::uint64_t events = prof.Get(wxg4::Counter::Events);
+    if (events > 0 && runTime.count() > 0.) {
+        std::cout << "[RunAction] Débit : " << events / runTime.count()
+                  << " évt/s (" << fLabel << ")\n";
+    }
+    if (events > 0) {
+        std::cout << "[RunAction] " << events << " événements, temps/évt : moyen "
+                  << 1e3 * prof.EventTimeMean() << " ms, min "
+                  << 1e3 * prof.EventTimeMin() << " ms, max " << 1e3 * prof.EventTimeMax() << " ms"
+                  << " | traces arrêtées par anticipation : "
+                  << prof.Get(wxg4::Counter::KilledTracks) << "\n";
+    }
+    prof.Print(std::cout);
+    std::string profile, volumesCsv;
+    if (!fProfilePath.empty()) {
+        const std::size_t dot = fProfilePath.rfind('.');
+        const std::string stem = fProfilePath.substr(0, dot);
+        const std::string ext  = (dot == std::string::npos) ? "" : fProfilePath.substr(dot);
+        profile    = stem + fRunTag + ext;
+        volumesCsv = stem + fRunTag + "_volumes.csv";
+    }
+    wxg4::VolumeProfiler::Report(std::cout, volumesCsv);
+    if (!profile.empty()) {
+        if (prof.Write(profile)) {
+            std::cout << "[RunAction] Profil écrit dans " << profile << "\n";
+        } else {
+            std::cerr << "[RunAction] Impossible d'écrire " << profile << "\n";
+        }
+    }
 
-    // 1. Avant écriture/fermeture, le fichier est-il visible ?
-    std::cout << "[DEBUG RunAction] Avant Write+Close, output.root existe ? "
-              << std::filesystem::exists("output.root") << "\n";
+    // Matrice de réponse : total des threads
+    if (!fResponseFile.empty()) {
+        const std::size_t dot = fResponseFile.rfind('.');
+        const std::string response = (dot == std::string::npos)
+            ? fResponseFile + fRunTag
+            : fResponseFile.substr(0, dot) + fRunTag + fResponseFile.substr(dot);
+        std::string err;
+        if (wxg4::ResponseMatrix::SaveTotal(response, err)) {
+            std::cout << "[RunAction] Matrice de réponse écrite dans " << response << "\n";
+        } else {
+            std::cerr << "[RunAction] Matrice de réponse : " << err << "\n";
+        }
+    }
 
-    // 2. On écrit et on ferme
-    std::cout << "[DEBUG RunAction] -> Write()\n";
-    man->Write();
-    std::cout << "[DEBUG RunAction] -> CloseFile()\n";
-    man->CloseFile();
+    // Noyaux de transmission de la cible : total des threads
+    if (!fKernelFile.empty()) {
+        std::string err;
+        if (wxg4::TransmissionKernel::SaveTotal(fKernelFile, err)) {
+            std::cout << "[RunAction] Noyaux de transmission écrits dans " << fKernelFile << "\n";
+        } else {
+            std::cerr << "[RunAction] Noyaux de transmission : " << err << "\n";
+        }
+    }
+}
+
+void MyRunAction::BufferHits(G4int eventID, const MyPixelHitsCollection& hits)
+{
+    const std::size_t n = hits.entries();
+    const std::size_t first = fHitRows.size();
+    const std::uint64_t event = GlobalEvent(eventID);
+    wxg4::Profiler::Instance().Add(wxg4::Counter::Hits, n);
 
-    // 3. Vérifs post-fermeture
+    // Défaut (versement à chaque événement, sans journal) : lignes remplies
+    // directement depuis la collection, sans passer par le tampon
+    if (fFlushEvery == 1 && !fJournal && fHitRows.empty()) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const MyPixelHit* hit = hits[i];
+            const G4ThreeVector& p = hit->GetMomentum();
+            FillRow({event, p.x(), p.y(), p.z(), hit->GetWeight()});
+        }
+        return;
+    }
 
-    std::cout << "[DEBUG RunAction] Après CloseFile, output.root existe ? "
-              << std::filesystem::exists("output.root") << "\n";
+    for (std::size_t i = 0; i < n; ++i) {
+        const MyPixelHit* hit = hits[i];
+        const G4ThreeVector& p = hit->GetMomentum();
+        fHitRows.push_back({event, p.x(), p.y(), p.z(), hit->GetWeight()});
+    }
+
+    // Événement terminé : journalisé, point de reprise tous les N événements
+    if (fJournal) {
+        fJournal->Append(event, fHitRows.data() + first, static_cast<std::uint32_t>(n));
+        if (++fSinceSync >= fCheckpointEvery) {
+            fJournal->Sync();
+            fSinceSync = 0;
+        }
+    }
+    if (++fPendingEvents >= fFlushEvery) FlushHits();
+}
+
+void MyRunAction::FillRow(const HitRow& row)
+{
+    auto* man = G4AnalysisManager::Instance();
+    man->FillNtupleIColumn(0, static_cast<G4int>(row.event));   // colonne 0 : eventID
+    man->FillNtupleDColumn(1, row.px);        // colonne 1 : px
+    man->FillNtupleDColumn(2, row.py);        // colonne 2 : py
+    man->FillNtupleDColumn(3, row.pz);        // colonne 3 : pz
+    man->FillNtupleDColumn(4, row.w);         // colonne 4 : poids
+    man->AddNtupleRow(0);
+}
+
+void MyRunAction::FlushHits()
+{
+    for (const HitRow& row : fHitRows) FillRow(row);
+    fHitRows.clear();
+    fPendingEvents = 0;
+}
+
+void MyRunAction::AddEventTime(double seconds)
+{
+    wxg4::Profiler::Instance().AddEventTime(seconds);
+}
+
+void MyRunAction::CountKilledTrack()
+{
+    wxg4::Profiler::Instance().Add(wxg4::Counter::KilledTracks);
 }
@@ -5,14 +5,124 @@
 #include <G4UserRunAction.hh>
 #include <G4Run.hh>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hit.hh"
+#include "checkpoint.hh"
+
+namespace wxg4 { class VolumeProfiler; class ResponseMatrix; class TransmissionKernel; }
+
 class MyRunAction : public G4UserRunAction
 {
 public:
-    MyRunAction();
+    /// @param label        configuration physique, rappelée dans le rapport de débit
+    /// @param profilePath  résumé du profil en fin de run (vide = affichage seul)
+    explicit MyRunAction(const std::string& label = "",
+                         const std::string& profilePath = "");
     ~MyRunAction() override;
 
     void BeginOfRunAction(const G4Run*) override;
     void EndOfRunAction  (const G4Run*) override;
+
+    /// Durée réelle d'un événement [s] (appelé par MyEventAction), cumulée
+    /// dans le profil du processus pour que le maître publie le total
+    void AddEventTime(double seconds);
+    /// Trace arrêtée par anticipation (stepping/stacking), même compteur partagé
+    void CountKilledTrack();
+    /**
+     * Suffixe des fichiers des runs suivants, commun à tous les threads
+     * (balayage : "_t2mm" -> output_t2mm.root, profile_t2mm.json).
+     * Vide = output.root, comme auparavant.
+     */
+    static void SetRunTag(const std::string& tag) { fRunTag = tag; }
+    /// Nom de base des sorties (défaut "output", /wxg4/output)
+    static void SetOutputBase(const std::string& base) { fOutputBase = base; }
+    static std::string OutputFile() { return fOutputBase + fRunTag + ".root"; }
+
+    /**
+     * Hits d'un événement (appelé par MyEventAction) : copiés dans un
+     * tampon, versés au ntuple tous les N événements et en fin de run.
+     * Versés directement, sans copie, avec N = 1 et sans journal de
+     * reprise. Le ntuple garde une ligne par hit (cinq Fill et un
+     * AddNtupleRow chacune) : le format lu par les outils ne change pas.
+     */
+    void BufferHits(G4int eventID, const MyPixelHitsCollection& hits);
+    /// Verse le tampon dans le ntuple "momenta"
+    void FlushHits();
+    /// N événements par versement (1 = à chaque fin d'événement)
+    void SetFlushPeriod(unsigned nEvents) { fFlushEvery = nEvents ? nEvents : 1; }
+
+    /// Profil par volume de ce thread, versé au total en fin de run
+    void SetVolumeProfiler(wxg4::VolumeProfiler* volumes) { fVolumes = volumes; }
+    wxg4::VolumeProfiler* GetVolumeProfiler() const { return fVolumes; }
+
+    /**
+     * Mode matrice de réponse : table de ce thread (versée au total en fin
+     * de run) et fichier où le maître écrit le total (suffixe de run inclus).
+     */
+    void SetResponse(wxg4::ResponseMatrix* response) { fResponse = response; }
+    void SetResponseFile(const std::string& path) { fResponseFile = path; }
+    /// Calibration de la cible : même schéma pour les noyaux de transmission
+    void SetTransmission(wxg4::TransmissionKernel* kernel) { fKernel = kernel; }
+    void SetTransmissionFile(const std::string& path) { fKernelFile = path; }
+
+    /**
+     * Points de reprise des runs suivants, communs à tous les threads :
+     * journal par thread dans dir, synchronisé tous les `every` événements,
+     * numéroté `generation` (0 = premier lancement). dir vide = aucun.
+     */
+    static void SetCheckpoint(const std::string& dir, unsigned every, unsigned generation);
+    /**
+     * Reprise : numéros (dans le run complet) des événements restant à
+     * simuler, et hits des journaux, rejoués dans le ntuple au début du
+     * run. Vides = run ordinaire.
+     */
+    static void SetResume(std::vector<std::uint64_t> events, std::vector<wxg4::JournalRow> rows);
+    /// Numéro dans le run complet de l'événement eventID du run en cours
+    static std::uint64_t GlobalEvent(G4int eventID)
+    {
+        return fEventMap.empty() ? static_cast<std::uint64_t>(eventID)
+                                 : fEventMap[static_cast<std::size_t>(eventID)];
+    }
+
+private:
+    static inline std::string fRunTag;
+    static inline std::string fOutputBase = "output";
+    static inline std::string fCheckpointDir;
+    static inline unsigned    fCheckpointEvery = 1000;
+    static inline unsigned    fGeneration = 0;
+    static inline std::vector<std::uint64_t>    fEventMap;
+    static inline std::vector<wxg4::JournalRow> fReplay;
+    static inline std::atomic<bool>             fReplayTaken{false};
+
+    std::string   fLabel;
+    std::string   fProfilePath;
+    wxg4::VolumeProfiler* fVolumes = nullptr;
+    wxg4::ResponseMatrix* fResponse = nullptr;
+    std::string   fResponseFile;
+    wxg4::TransmissionKernel* fKernel = nullptr;
+    std::string   fKernelFile;
+    std::chrono::steady_clock::time_point fRunStart;
+
+    bool          fNtupleBooked = false;
+
+    /// Une ligne du ntuple "momenta"
+    static void FillRow(const wxg4::JournalRow& row);
+
+    // Hits en attente d'écriture (une ligne du ntuple chacun), au format
+    // du journal de reprise
+    using HitRow = wxg4::JournalRow;
+    std::vector<HitRow> fHitRows;
+    unsigned            fFlushEvery    = 1;
+    unsigned            fPendingEvents = 0;
+
+    std::unique_ptr<wxg4::CheckpointJournal> fJournal;   // journal de ce thread
+    unsigned            fSinceSync = 0;
 };
 
 #endif // RUN_HH
@@ -0,0 +1,75 @@
+// src/sampling.cc
+#include "sampling.hh"
+
+#include <algorithm>
+#include <iostream>
+
+namespace wxg4
+{
+
+bool parse_sampler(const std::string& name, Sampler& out)
+{
+    if      (name == "random")     out = Sampler::Random;
+    else if (name == "systematic") out = Sampler::Systematic;
+    else if (name == "stratified") out = Sampler::Stratified;
+    else if (name == "reservoir")  out = Sampler::Reservoir;
+    else return false;
+    return true;
+}
+
+const char* sampler_name(Sampler s)
+{
+    switch (s) {
+        case Sampler::Random:     return "random";
+        case Sampler::Systematic: return "systematic";
+        case Sampler::Stratified: return "stratified";
+        case Sampler::Reservoir:  return "reservoir";
+    }
+    return "?";
+}
+
+std::vector<std::uint32_t> build_sample_index(
+    const ParticleView& pdata,
+    std::size_t n,
+    Sampler scheme,
+    std::mt19937& gen)
+{
+    std::vector<std::uint32_t> index;
+    const std::size_t NP = pdata.ws.size();
+    if (n == 0 || NP == 0) return index;
+
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    index.resize(n);
+
+    // Échantillon réservoir : parts égales, les poids sont déjà dans wb
+    if (scheme == Sampler::Reservoir) {
+        const double u0 = dist(gen);
+        const double stride = static_cast<double>(NP) / static_cast<double>(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            const auto j = static_cast<std::size_t>((static_cast<double>(k) + u0) * stride);
+            index[k] = static_cast<std::uint32_t>(std::min(j, NP - 1));
+        }
+        std::cout << "[sampling] Index reservoir : " << n << " événements sur "
+                  << NP << " particules échantillonnées\n";
+        return index;
+    }
+
+    const double total = pdata.ws.back();
+    const double step  = total / static_cast<double>(n);
+
+    // Les cibles sont croissantes : un seul parcours de ws suffit
+    const double u0 = dist(gen);
+    std::size_t j = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        const double u = (scheme == Sampler::Stratified) ? dist(gen) : u0;
+        const double target = (static_cast<double>(k) + u) * step;
+        while (j + 1 < NP && pdata.ws[j] < target) ++j;
+        index[k] = static_cast<std::uint32_t>(j);
+    }
+
+    std::cout << "[sampling] Index " << sampler_name(scheme) << " : "
+              << n << " tirages sur " << NP << " particules\n";
+    return index;
+}
+
+} // namespace wxg4
@@ -0,0 +1,47 @@
+// src/sampling.hh
+#ifndef SAMPLING_HH
+#define SAMPLING_HH
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+
+namespace wxg4
+{
+
+/// Manière de choisir les particules simulées
+enum class Sampler {
+    Random,      // tirage pondéré avec remise, un par événement (historique)
+    Systematic,  // rééchantillonnage systématique, index précalculé
+    Stratified,  // rééchantillonnage stratifié, index précalculé
+    Reservoir    // échantillon pondéré en une passe à la lecture (reservoir.hh)
+};
+
+/// "random" | "systematic" | "stratified" | "reservoir" ; renvoie false si inconnu
+bool parse_sampler(const std::string& name, Sampler& out);
+const char* sampler_name(Sampler s);
+
+/**
+ * Construit un index de n particules tirées proportionnellement aux poids
+ * (ws cumulés). La somme des poids est découpée en n strates égales :
+ *  - Systematic : un seul décalage aléatoire, commun à toutes les strates ;
+ *  - Stratified : un décalage indépendant par strate.
+ * Une particule de poids w apparaît floor(n·w/W) ou ceil(n·w/W) fois
+ * (systematic), ce qui évite doublons et oublis d'un tirage avec remise.
+ * L'index est trié par ordre croissant : les événements le consomment
+ * séquentiellement, avec un accès mémoire contigu.
+ * Reservoir : l'échantillon est déjà tiré selon les poids (poids portés
+ * par wb) ; chaque particule revient floor(n/NP) ou ceil(n/NP) fois.
+ */
+std::vector<std::uint32_t> build_sample_index(
+    const ParticleView& pdata,
+    std::size_t n,
+    Sampler scheme,
+    std::mt19937& gen);
+
+} // namespace wxg4
+
+#endif // SAMPLING_HH
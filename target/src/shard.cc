@@ -0,0 +1,155 @@
+// src/shard.cc
+#include "shard.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace wxg4
+{
+
+bool parse_shard(const std::string& text, Shard& out)
+{
+    std::istringstream is(text);
+    long k = -1, n = 0;
+    char slash = 0;
+    if (!(is >> k >> slash >> n) || slash != '/' || !is.eof()) return false;
+    if (n < 1 || k < 0 || k >= n) return false;
+    out.index = static_cast<unsigned>(k);
+    out.count = static_cast<unsigned>(n);
+    return true;
+}
+
+std::string shard_suffix(const Shard& shard)
+{
+    if (!shard.Active()) return "";
+    // Largeur fixe : les sorties d'un même découpage se trient dans l'ordre
+    const int width = static_cast<int>(std::to_string(shard.count).size());
+    char buf[64];
+    std::snprintf(buf, sizeof buf, "_shard%0*uof%u", width, shard.index, shard.count);
+    return buf;
+}
+
+void shard_range(std::uint64_t total, const Shard& shard,
+                 std::uint64_t& first, std::uint64_t& n)
+{
+    const std::uint64_t base = total / shard.count;
+    const std::uint64_t rest = total % shard.count;
+    // Les `rest` premiers shards reçoivent un enregistrement de plus
+    first = shard.index * base + std::min<std::uint64_t>(shard.index, rest);
+    n     = base + (shard.index < rest ? 1 : 0);
+}
+
+std::uint64_t systematic_first(std::uint64_t n, double u, double offset, double total)
+{
+    if (total <= 0.) return 0;
+    const double x = std::ceil(static_cast<double>(n) * offset / total - u);
+    return x <= 0. ? 0 : std::min<std::uint64_t>(n, static_cast<std::uint64_t>(x));
+}
+
+std::uint64_t stream_seed(std::uint64_t base, std::uint64_t stream)
+{
+    std::uint64_t z = base + 0x9E3779B97F4A7C15ull * (stream + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+bool write_shard_summary(const std::string& path, const ShardSummary& s, std::string& err)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        err = "cannot create " + path;
+        return false;
+    }
+    out.precision(17);
+    out << "shard "     << s.shard.index << "/" << s.shard.count << "\n"
+        << "seed "      << s.seed      << "\n"
+        << "particles " << s.particles << "\n"
+        << "events "    << s.events    << "\n"
+        << "weight "    << s.weight    << "\n"
+        << "output "    << s.output    << "\n";
+    if (!out) {
+        err = "write error on " + path;
+        return false;
+    }
+    return true;
+}
+
+bool read_shard_summary(const std::string& path, ShardSummary& s, std::string& err)
+{
+    std::ifstream in(path);
+    if (!in) {
+        err = "cannot open " + path;
+        return false;
+    }
+    ShardSummary r;
+    bool hasShard = false, hasEvents = false, hasWeight = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::size_t sp = line.find(' ');
+        if (sp == std::string::npos) continue;
+        const std::string key = line.substr(0, sp), value = line.substr(sp + 1);
+        std::istringstream is(value);
+        if      (key == "shard")     hasShard = parse_shard(value, r.shard);
+        else if (key == "seed")      is >> r.seed;
+        else if (key == "particles") is >> r.particles;
+        else if (key == "events")    hasEvents = static_cast<bool>(is >> r.events);
+        else if (key == "weight")    hasWeight = static_cast<bool>(is >> r.weight);
+        else if (key == "output")    r.output = value;
+    }
+    if (!hasShard || !hasEvents || !hasWeight || r.output.empty()) {
+        err = path + " is not a shard summary";
+        return false;
+    }
+    s = r;
+    return true;
+}
+
+bool shard_weight_factors(const std::vector<ShardSummary>& shards,
+                          std::vector<double>& factors, std::string& err)
+{
+    if (shards.empty()) {
+        err = "no shard";
+        return false;
+    }
+    const unsigned count = shards.front().shard.count;
+    std::vector<bool> seen(count, false);
+    double weight = 0.;
+    std::uint64_t events = 0;
+    for (const auto& s : shards) {
+        if (s.shard.count != count || s.seed != shards.front().seed) {
+            err = "shards from different runs (count or seed differ): " + s.output;
+            return false;
+        }
+        if (seen[s.shard.index]) {
+            err = "shard " + std::to_string(s.shard.index) + " given twice";
+            return false;
+        }
+        seen[s.shard.index] = true;
+        weight += s.weight;
+        events += s.events;
+    }
+    for (unsigned k = 0; k < count; ++k) {
+        if (!seen[k]) {
+            err = "missing shard " + std::to_string(k) + "/" + std::to_string(count);
+            return false;
+        }
+    }
+    if (events == 0 || weight <= 0.) {
+        err = "shards contain no event";
+        return false;
+    }
+
+    // Tranche vide (ou sans événement) : aucun hit, facteur sans objet
+    const double perEvent = weight / static_cast<double>(events);
+    factors.clear();
+    for (const auto& s : shards) {
+        factors.push_back(s.events ? (s.weight / static_cast<double>(s.events)) / perEvent : 0.);
+    }
+    return true;
+}
+
+} // namespace wxg4
@@ -0,0 +1,79 @@
+// src/shard.hh
+#ifndef SHARD_HH
+#define SHARD_HH
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wxg4
+{
+
+/**
+ * Découpage d'un run en N processus indépendants (--shard k/N) : le
+ * shard k lit la tranche k de chaque espèce, tire ses événements dans
+ * cette tranche avec son propre flux aléatoire et écrit ses sorties
+ * suffixées "_shard<k>of<N>". merge_shards recombine les tranches.
+ */
+struct Shard {
+    unsigned index = 0;   // k, dans [0, count)
+    unsigned count = 1;   // N (1 = pas de découpage)
+
+    bool Active() const { return count > 1; }
+};
+
+/// Lit "k/N" (0 <= k < N) ; false si la forme est invalide
+bool parse_shard(const std::string& text, Shard& out);
+
+/// Suffixe des sorties du shard ("_shard03of16"), vide si inactif
+std::string shard_suffix(const Shard& shard);
+
+/// Tranche [first, first + n) du shard parmi total enregistrements (tailles à 1 près)
+void shard_range(std::uint64_t total, const Shard& shard,
+                 std::uint64_t& first, std::uint64_t& n);
+
+/**
+ * Tirage systématique global de n points (i + u) W / n, i < n, u dans
+ * [0,1[ commun à tous les shards : indice du premier point tombant au-delà
+ * de offset (poids cumulé des tranches précédentes). Les événements du
+ * shard sont les points entre sa borne et celle du shard suivant (n pour
+ * le dernier) : à peu de chose près proportionnels au poids de sa tranche.
+ */
+std::uint64_t systematic_first(std::uint64_t n, double u, double offset, double total);
+
+/**
+ * Graine du flux `stream` dérivée de la graine de base (splitmix64) :
+ * flux décorrélés pour les shards et les threads d'une même base.
+ */
+std::uint64_t stream_seed(std::uint64_t base, std::uint64_t stream);
+
+/**
+ * Bilan d'un run de shard, écrit à côté de sa sortie (output_*.shard)
+ * et lu par merge_shards : de quoi renormaliser les poids des tranches.
+ */
+struct ShardSummary {
+    Shard         shard;
+    std::uint64_t seed      = 0;    // graine de base commune aux shards
+    std::uint64_t particles = 0;    // particules de la tranche après filtrage
+    std::uint64_t events    = 0;    // primaires simulés
+    double        weight    = 0.;   // poids total de tirage de la tranche
+    std::string   output;           // fichier de hits du shard
+};
+
+/// Écrit summary dans path ("clé valeur" par ligne) ; false avec err sinon
+bool write_shard_summary(const std::string& path, const ShardSummary& summary, std::string& err);
+bool read_shard_summary(const std::string& path, ShardSummary& summary, std::string& err);
+
+/**
+ * Facteur de poids de chaque shard pour que leur réunion équivaille à un
+ * seul run : un événement du shard k représente weight_k / events_k, un
+ * événement du run complet sum(weight) / sum(events).
+ * @return false (avec err) si les shards ne forment pas un ensemble 0..N-1
+ *         complet et cohérent
+ */
+bool shard_weight_factors(const std::vector<ShardSummary>& shards,
+                          std::vector<double>& factors, std::string& err);
+
+} // namespace wxg4
+
+#endif // SHARD_HH
@@ -2,8 +2,10 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 #include "G4RunManager.hh"
+#include "G4RunManagerFactory.hh"
 #include "G4UImanager.hh"
 #include "G4VisManager.hh"
 #include "G4VisExecutive.hh"
@@ -11,94 +13,221 @@
 
 #include "G4PhysListFactory.hh"
 #include "G4VModularPhysicsList.hh"
+#include "G4FastSimulationPhysics.hh"
 #include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
 
 #include "construction.hh"
 #include "action.hh"
+#include "controller.hh"
+#include "messenger.hh"
+#include "run.hh"
+#include "options.hh"
+#include "source.hh"
+#include "mpi.hh"
+#include "kernel.hh"
+#include "fastsim.hh"
+#include "profiler.hh"
+#include "compare.hh"
 
-#include <openPMD/openPMD.hpp>
+// Épaisseur de départ quand la macro ne fixe pas /wxg4/thickness
+constexpr double DEFAULT_THICKNESS_MM = 1.0;
 
-// Constante pour activer/désactiver l'UI
-constexpr bool ENABLE_UI = false;   // <- change à true si tu veux toujours UI
-
-int main(int argc, char** argv)
+/**
+ * Même run en transport détaillé puis avec les noyaux de la cible
+ * (sorties *_full.root et *_fast.root), relues à la fin : hits par
+ * événement avec leur erreur tirée de la dispersion entre événements,
+ * spectres p, T et theta comparés bin à bin (chi2 et plus grand écart,
+ * erreurs par lots d'événements), temps par événement et accélération.
+ */
+static void validate_fast_target(MyRunController& controller, std::uint64_t nEvents)
 {
-    if (argc < 5) {
-        std::fprintf(stderr,
-            "Usage: %s <openPMD_path> <species> <iteration> <thickness_mm> [fraction_percent]\n",
-            (argv && argv[0]) ? argv[0] : "read_warpx_particles");
-        return 1;
+    struct Pass { double seconds; std::uint64_t events; std::string file; };
+    auto& prof = wxg4::Profiler::Instance();
+    auto run = [&](bool fast, const char* tag) {
+        MyTargetFastModel::SetEnabled(fast);
+        MyRunAction::SetRunTag(tag);
+        controller.BeamOn(nEvents);
+        return Pass{prof.Seconds(wxg4::Stage::EventLoop), prof.Get(wxg4::Counter::Events),
+                    MyRunAction::OutputFile()};
+    };
+    const Pass full = run(false, "_full");
+    const Pass fast = run(true,  "_fast");
+    MyTargetFastModel::SetEnabled(true);
+    MyRunAction::SetRunTag("");
+
+    const wxg4::CompareConfig cfg;
+    wxg4::HitSample sfull, sfast;
+    std::string err;
+    if (!wxg4::read_hit_sample(full.file, full.events, cfg, sfull, err)
+        || !wxg4::read_hit_sample(fast.file, fast.events, cfg, sfast, err)) {
+        G4cerr << "[fast] validation : " << err << G4endl;
+        return;
     }
+    std::ostringstream report;
+    wxg4::print_sample_diff(report, "[fast]   ", "détaillé", "rapide",
+                            wxg4::compare_hit_samples(sfull, sfast));
+    G4cout << "[fast] validation sur " << nEvents << " événements ("
+           << full.file << " / " << fast.file << ") :\n"
+           << report.str()
+           << "[fast]   temps/évt détaillé " << 1e3 * full.seconds / std::max<std::uint64_t>(full.events, 1)
+           << " ms | rapide " << 1e3 * fast.seconds / std::max<std::uint64_t>(fast.events, 1)
+           << " ms | accélération x" << (fast.seconds > 0. ? full.seconds / fast.seconds : 0.)
+           << G4endl;
+}
 
-    const std::string opmdPath   = argv[1];
-    const std::string species    = argv[2];
-    const int iteration          = std::stoi(argv[3]);
-    const double thickness_mm    = std::atof(argv[4]);
-    const double fraction_pct    = (argc >= 6) ? std::atof(argv[5]) : 10.0;
+int main(int argc, char** argv)
+{
+    // MPI (build WXG4_USE_MPI, mpirun -np N) : le rang r traite le shard r/N
+    wxg4::MpiSession mpi(argc, argv);
 
-    if (thickness_mm <= 0.0) {
-        G4cerr << "Error: thickness_mm must be > 0.\n";
+    wxg4::RunOptions opts;
+    std::string err;
+    if (!wxg4::parse_options(argc, argv, opts, err)) {
+        G4cerr << "Error: " << err << "\n";
+        wxg4::print_usage((argv && argv[0]) ? argv[0] : nullptr);
         return 1;
     }
-    if (fraction_pct <= 0.0) {
-        G4cerr << "Error: fraction_percent must be > 0.\n";
-        return 1;
+    if (mpi.Active()) {
+        if (opts.shard.Active() || !opts.response.empty() || !opts.calibrateTarget.empty()
+            || opts.ui || opts.fastValidate || opts.stream) {
+            G4cerr << "Error: under mpirun each rank is a shard of a WarpX batch run "
+                      "(no --shard, --response, --calibrate-target, --ui, --fast-validate, --stream)\n";
+            return 1;
+        }
+        opts.shard = {static_cast<unsigned>(mpi.Rank()), static_cast<unsigned>(mpi.Size())};
     }
+    const bool macroMode = !opts.macro.empty();
+    if (macroMode && opts.thickness_mm <= 0.0) opts.thickness_mm = DEFAULT_THICKNESS_MM;
 
-    const G4double thickness = thickness_mm * mm;
-    const double fraction    = fraction_pct / 100.0;
+    // Balayage : la géométrie est construite avec la première épaisseur
+    const G4double thickness = (opts.sweep_mm.empty() ? opts.thickness_mm : opts.sweep_mm.front()) * mm;
 
-    // --- Lecture openPMD pour compter les particules
-    openPMD::Series series(opmdPath, openPMD::Access::READ_ONLY);
+    // --- Initialisation Geant4 : multithread si demandé (--threads N, que
+    // /wxg4/threads peut ensuite changer avant /run/initialize)
+    const bool mt = opts.threads > 1;
+    auto* runManager = G4RunManagerFactory::CreateRunManager(
+        mt ? G4RunManagerType::Default : G4RunManagerType::Serial);
+    if (mt) runManager->SetNumberOfThreads(opts.threads);
 
-    if (series.iterations.count(iteration) == 0) {
-        G4cerr << "Iteration " << iteration << " not found in series!\n";
-        return 1;
+    // Shard : flux aléatoire propre, dérivé de la graine commune et de k
+    std::uint64_t seed = 0;
+    if (opts.seed != 0 || opts.shard.Active()) {
+        seed = wxg4::stream_seed(opts.seed, opts.shard.index);
+        const long seeds[3] = {static_cast<long>((seed & 0x7fffffff) | 1),
+                               static_cast<long>((seed >> 32) & 0x7fffffff), 0};
+        G4Random::setTheSeeds(seeds);
+        G4cout << "[seed] base=" << opts.seed << " flux=" << opts.shard.index
+               << " -> " << seeds[0] << ", " << seeds[1] << G4endl;
     }
-    auto it = series.iterations[iteration];
-
-    if (it.particles.count(species) == 0) {
-        G4cerr << "Species '" << species << "' not found!\n";
-        return 1;
+    const std::string globalProfile = opts.profile;
+    if (opts.shard.Active() && !opts.profile.empty()) {
+        const std::size_t dot = opts.profile.rfind('.');
+        opts.profile.insert(dot == std::string::npos ? opts.profile.size() : dot,
+                            wxg4::shard_suffix(opts.shard));
     }
 
-    auto &px = it.particles[species]["momentum"]["x"];
-    const uint64_t nb_particles = px.getExtent()[0];
+    auto* detector = new MyDetectorConstruction(
+        thickness, opts.cutTarget_mm * mm, opts.cutDetector_mm * mm);
+    runManager->SetUserInitialization(detector);
 
-    uint64_t nEvents = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(nb_particles)));
-    if (nEvents == 0) nEvents = 1;
-    if (nEvents > nb_particles) nEvents = nb_particles;
+    // Liste physique choisie à l'exécution ; coupure du monde = défaut de la liste
+    G4PhysListFactory factory;
+    const G4String physName = wxg4::physics_list_name(opts.physics, opts.em);
+    if (!factory.IsReferencePhysList(physName)) {
+        G4cerr << "Error: unknown reference physics list '" << physName << "'\n";
+        return 1;
+    }
+    G4VModularPhysicsList* physicsList = factory.GetReferencePhysList(physName);
+    physicsList->SetDefaultCutValue(opts.cutWorld_mm * mm);
 
-    G4cout << "[openPMD] particles=" << nb_particles
-           << " | fraction=" << fraction_pct << "% -> nEvents=" << nEvents << G4endl;
+    // Transport rapide de la cible : noyaux lus une fois, partagés par les threads
+    wxg4::TransmissionKernel kernel;
+    if (!opts.fastTarget.empty()) {
+        if (!kernel.Load(opts.fastTarget, err)) {
+            G4cerr << "Error: " << err << "\n";
+            return 1;
+        }
+        G4cout << "[fast] " << opts.fastTarget << " : " << kernel.NHistories()
+               << " histoires, cible de " << kernel.Thickness() << " mm" << G4endl;
+        auto* fastSim = new G4FastSimulationPhysics();
+        for (const auto& name : kernel.Names()) fastSim->ActivateFastSimulation(name);
+        physicsList->RegisterPhysics(fastSim);
+        detector->SetTransmissionKernel(&kernel);
+    }
+    runManager->SetUserInitialization(physicsList);
+    G4cout << "[physics] " << wxg4::physics_label(opts) << G4endl;
 
-    // --- Initialisation Geant4
-    auto* runManager = new G4RunManager();
+    // Particules primaires : chargées une fois par processus, partagées
+    // en lecture par les générateurs de tous les threads
+    wxg4::ParticleSource source;
+    source.SetSeed(seed);
+    runManager->SetUserInitialization(new MyActionInitialization(opts, detector, &source));
 
-    runManager->SetUserInitialization(new MyDetectorConstruction(thickness));
+    MyRunController controller(opts, runManager, detector, &source);
+    MyMessenger messenger(&controller);
+    if (opts.shard.Active()) controller.SetOutput("output");
+    if (mpi.Active()) controller.SetMpi(&mpi, globalProfile);
 
-    G4PhysListFactory factory;
-    G4VModularPhysicsList* physicsList = factory.GetReferencePhysList("QGSP_BERT_EMZ");
-    runManager->SetUserInitialization(physicsList);
+    G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
-    runManager->SetUserInitialization(new MyActionInitialization(opmdPath, species, iteration));
+    if (macroMode) {
+        // Tous les paramètres viennent de la macro (/wxg4/..., /wxg4/beamOn)
+        UImanager->ApplyCommand("/control/execute " + opts.macro);
+        delete runManager;
+        return 0;
+    }
 
-    runManager->Initialize();
+    // --- Lecture des données (ou bins de la matrice de réponse / de la
+    // calibration), initialisation
+    const bool responseMode  = !opts.response.empty();
+    const bool calibrateMode = !opts.calibrateTarget.empty();
+    if (responseMode || calibrateMode) {
+        // Pas de données WarpX : nEvents = bins x primaires par bin
+        if (responseMode) {
+            const wxg4::ResponseBinning bins = wxg4::response_binning(opts);
+            opts.nEvents = bins.NIn() * opts.responseEvents;
+            G4cout << "[response] " << bins.NEnergy() << " x " << bins.NTheta()
+                   << " bins d'entrée x " << opts.responseEvents << " " << opts.responseParticle
+                   << " -> nEvents=" << opts.nEvents << " -> " << opts.response << G4endl;
+        } else {
+            opts.nEvents = opts.calibrateParticles.size() * opts.calibrateEnergy.n
+                         * opts.calibrateAngle.n * opts.calibrateHistories;
+            G4cout << "[calibrate] " << opts.calibrateParticles.size() << " particule(s) x "
+                   << opts.calibrateEnergy.n << " x " << opts.calibrateAngle.n << " bins x "
+                   << opts.calibrateHistories << " -> nEvents=" << opts.nEvents
+                   << " -> " << opts.calibrateTarget << G4endl;
+        }
+        wxg4::ScopeTimer timer(wxg4::Stage::Initialize);
+        runManager->Initialize();
+    } else if (opts.stream) {
+        // Flux : les données arrivent itération par itération (StreamRuns)
+        wxg4::ScopeTimer timer(wxg4::Stage::Initialize);
+        runManager->Initialize();
+    } else if (!controller.Prepare()) {
+        delete runManager;
+        return 1;
+    }
+    auto beamOn = [&](std::uint64_t nEvents) {
+        if (responseMode || calibrateMode) {
+            runManager->BeamOn(static_cast<G4int>(nEvents));
+        } else {
+            controller.BeamOn(nEvents);
+        }
+    };
 
     // --- UI / batch
     G4VisManager* visManager = new G4VisExecutive();
     visManager->Initialize();
 
-    G4UImanager* UImanager = G4UImanager::GetUIpointer();
-
     // alias N utilisable dans run.mac : /run/beamOn {N}
     {
         std::ostringstream oss;
-        oss << nEvents;
+        oss << opts.nEvents;
         UImanager->ApplyCommand(G4String("/control/alias N ") + oss.str());
     }
 
-    if (ENABLE_UI) {
+    if (opts.ui) {
         G4UIExecutive* ui = new G4UIExecutive(argc, argv);
 
         // vis.mac si présent
@@ -115,13 +244,36 @@ int main(int argc, char** argv)
 
         ui->SessionStart();
         delete ui;
-    } else {
+    } else if (opts.stream) {
+        // batch, une simulation par itération publiée jusqu'à la fin du flux
+        if (controller.StreamRuns() < 0) {
+            delete visManager;
+            delete runManager;
+            return 1;
+        }
+    } else if (opts.fastValidate) {
+        // batch, validation du transport rapide contre le transport détaillé
+        validate_fast_target(controller, opts.nEvents);
+    } else if (opts.sweep_mm.empty()) {
         // batch
-        G4cout << "[batch] Calling BeamOn(" << nEvents << ").\n";
-        runManager->BeamOn(nEvents);
+        beamOn(opts.nEvents);
+    } else {
+        // batch, balayage : particules, tables physiques et pixels restent en
+        // place, seule la demi-longueur de la cible change entre deux runs
+        const std::uint64_t nEvents = opts.nEvents;
+        for (const double t_mm : opts.sweep_mm) {
+            if (!controller.SetThickness(t_mm * mm)) continue;
+
+            std::ostringstream tag;
+            tag << "_t" << t_mm << "mm";
+            MyRunAction::SetRunTag(tag.str());
+            G4cout << "[sweep] thickness=" << t_mm << " mm\n";
+            beamOn(nEvents);
+        }
+        MyRunAction::SetRunTag("");
     }
 
     delete visManager;
     delete runManager;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,267 @@
+// src/source.cc
+#include "source.hh"
+
+#include <G4ParticleTable.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <iostream>
+
+#include "sampling.hh"
+#include "reorder.hh"
+#include "biasing.hh"
+#include "profiler.hh"
+#include "cache.hh"
+#include "reservoir.hh"
+
+namespace wxg4
+{
+
+namespace
+{
+
+/// Coupure en énergie cinétique des primaires
+constexpr double kTcut_MeV = 50.0;
+
+} // namespace
+
+void ParticleSource::Reset()
+{
+    // Vue et fiches d'abord : elles peuvent pointer dans fPData ou fMap
+    fView = ParticleView{};
+    fTable.Clear();
+    fIndex.clear();
+    fPData = ParticleData{};
+    fMap.Close();
+    fRecords = 0;
+}
+
+bool ParticleSource::ResolveSpecies(const RunOptions& opts, std::vector<double>& masses_MeV)
+{
+    fDefs.clear();
+    masses_MeV.clear();
+    auto* table = G4ParticleTable::GetParticleTable();
+    const auto& species = opts.species;
+    for (const auto& sp : species) {
+        // Espèce unique sans correspondance : électrons, comme auparavant
+        const std::string g4name =
+            (sp.g4name.empty() && species.size() == 1) ? "e-" : sp.g4name;
+        G4ParticleDefinition* def =
+            g4name.empty() ? nullptr : table->FindParticle(g4name);
+        if (def == nullptr) {
+            G4ExceptionDescription desc;
+            desc << "Espèce '" << sp.name << "' : particule Geant4 '"
+                 << g4name << "' inconnue (utiliser nom:particule, "
+                 << "ex: " << sp.name << ":e-).";
+            G4Exception("ParticleSource", "UnknownSpecies",
+                        FatalErrorInArgument, desc);
+            return false;
+        }
+        fDefs.push_back(def);
+        masses_MeV.push_back(def->GetPDGMass() / MeV);
+        std::cout << "[Source] Espèce " << sp.name << " -> "
+                  << def->GetParticleName() << "\n";
+    }
+    return true;
+}
+
+bool ParticleSource::LoadCached(const RunOptions& opts)
+{
+    // Cache préfiltré : mêmes dataset, itération, espèces, coupure et tri
+    // (pas pour un réservoir : l'échantillon change avec la fraction et la graine)
+    if (opts.cacheDir.empty() || opts.sampler == Sampler::Reservoir) return false;
+
+    const std::string key  = particle_cache_key(opts.dataset, opts.species, opts.iteration,
+                                                kTcut_MeV, opts.sort, opts.shard);
+    if (key.empty()) return false;
+    const std::string path = particle_cache_path(opts.cacheDir, key);
+    Reset();
+    {
+        ScopeTimer timer(Stage::CacheLoad);
+        if (!fMap.Open(path, key)) return false;
+    }
+    std::vector<double> masses_MeV;
+    if (!ResolveSpecies(opts, masses_MeV)) return false;
+
+    // Colonnes et fiches lues en place dans la projection
+    fView    = fMap.View();
+    fRecords = fMap.records();
+    fTable.Attach(fMap.table(), fMap.size());
+    std::cout << "[Source] Cache " << path << " : " << fMap.size()
+              << " particules filtrées sur " << fRecords << "\n";
+    return Finish(opts);
+}
+
+bool ParticleSource::Load(const RunOptions& opts, openPMD::Series* series,
+                          openPMD::Iteration* step)
+{
+    Reset();
+
+    const std::string& dataset = opts.dataset;
+    const auto& species        = opts.species;
+    const int iteration        = opts.iteration;
+
+    // 1) Particule Geant4 associée à chaque espèce
+    std::vector<double> masses_MeV;
+    if (!ResolveSpecies(opts, masses_MeV)) return false;
+
+    // 2) Cache écrit après lecture et filtrage (lu par LoadCached) ; pas
+    // pour un flux : l'itération n'existe pas sur disque
+    const bool reservoir = opts.sampler == Sampler::Reservoir;
+    const bool useCache = !opts.cacheDir.empty() && step == nullptr && !reservoir;
+
+    if (reservoir) {
+        // Échantillon tiré pendant la lecture par blocs, filtre compris :
+        // seules les particules retenues sont gardées en mémoire
+        ReservoirParams params;
+        params.masses_MeV = masses_MeV;
+        params.Tcut_MeV   = kTcut_MeV;
+        params.fraction   = opts.fraction_pct / 100.0;
+        params.seed       = fSeed ? stream_seed(fSeed, 1) : 0;
+        params.threads    = static_cast<unsigned>(std::max(1, opts.threads));
+        {
+            ScopeTimer timer(Stage::OpenPMDLoad);
+            fPData = step   ? reservoir_sample_3d(*step, species, params, opts.shard)
+                   : series ? reservoir_sample_3d(*series, species, iteration, params, opts.shard)
+                            : reservoir_sample_3d(dataset, species, iteration, params, opts.shard);
+        }
+        Profiler::Instance().Add(Counter::Particles, fPData.px.size());
+        if (fPData.px.empty()) {
+            G4ExceptionDescription desc;
+            desc << "Réservoir vide : aucune particule avec T > " << kTcut_MeV << " MeV.";
+            G4Exception("ParticleSource", "ReservoirEmpty", JustWarning, desc);
+            return false;
+        }
+        {
+            ScopeTimer timer(Stage::Prepare);
+            sort_particles(fPData, opts.sort);
+        }
+    } else {
+        std::cout << "[Source] Chargement des données OpenPMD : "
+                  << dataset << ", " << species.size() << " espèce(s)"
+                  << ", itération=" << iteration;
+        if (opts.shard.Active()) {
+            std::cout << ", shard " << opts.shard.index << "/" << opts.shard.count;
+        }
+        std::cout << "\n";
+        {
+            ScopeTimer timer(Stage::OpenPMDLoad);
+            fPData = step   ? read_particle_data_3d(*step, species, opts.shard)
+                   : series ? read_particle_data_3d(*series, species, iteration, opts.shard)
+                            : read_particle_data_3d(dataset, species, iteration, opts.shard);
+        }
+        fRecords = fPData.px.size();
+        Profiler::Instance().Add(Counter::Particles, fPData.px.size());
+        std::cout << "[Source] Données chargées ("
+                  << fPData.px.size() << " particules)\n";
+
+        // 3) Pré-filtrage T > 50 MeV, masse propre à chaque espèce
+        const size_t oldN = fPData.px.size();
+        size_t kept;
+        {
+            ScopeTimer timer(Stage::Filter);
+            kept = filter_kinetic_energy(fPData, masses_MeV, kTcut_MeV);
+        }
+
+        if (kept == 0) {
+            G4ExceptionDescription desc;
+            desc << "Aucune particule avec T > " << kTcut_MeV
+                 << " MeV — on conserve l'ensemble original.";
+            G4Exception("ParticleSource", "HighEnergyFilterEmpty", JustWarning, desc);
+        } else {
+            std::cout << "[Source] Filtrage T > " << kTcut_MeV << " MeV : "
+                      << kept << " / " << oldN << " particules conservées.\n";
+        }
+
+        // Réordonnancement optionnel (énergie ou direction)
+        {
+            ScopeTimer timer(Stage::Prepare);
+            sort_particles(fPData, opts.sort);
+        }
+
+        // Cache : colonnes et fiches sans biais (le biais est appliqué à
+        // chaque chargement, d'après les options du run)
+        if (useCache) {
+            const std::string key = particle_cache_key(dataset, species, iteration,
+                                                       kTcut_MeV, opts.sort, opts.shard);
+            const std::string path = particle_cache_path(opts.cacheDir, key);
+            PrimaryTable table;
+            table.Build(fPData);
+            std::string err;
+            if (key.empty()) {
+                std::cout << "[Source] Cache non écrit : fichiers de " << dataset
+                          << " illisibles (taille, date)\n";
+            } else if (save_particle_cache(path, key, fPData, table, fRecords, err)) {
+                std::cout << "[Source] Cache écrit : " << path << "\n";
+            } else {
+                G4Exception("ParticleSource", "CacheWriteFailed",
+                            JustWarning, err.c_str());
+            }
+            if (opts.biasFile.empty()) fTable = std::move(table);
+        }
+    }
+    fView = fPData;
+    return Finish(opts);
+}
+
+bool ParticleSource::Finish(const RunOptions& opts)
+{
+    Profiler::Instance().Add(Counter::Kept, fView.px.size());
+
+    if (fView.energy_sorted && !fView.ek.empty()) {
+        // Bandes d'énergie de largeur x2 à partir de la coupure
+        std::vector<double> edges{kTcut_MeV};
+        while (edges.back() < fView.ek.back()) edges.push_back(2.0 * edges.back());
+        for (const auto& b : summarize_energy_bands(fView, edges)) {
+            std::cout << "[Source] T in ]" << b.Tmin << ", " << b.Tmax
+                      << "] MeV : " << b.count << " particules, poids "
+                      << b.weight << "\n";
+        }
+    }
+
+    ScopeTimer prepareTimer(Stage::Prepare);
+
+    // 4) Échantillonnage préférentiel : ws biaisé, wb compensatoire
+    // (pas pour un réservoir : wb y porte déjà les poids de l'échantillon).
+    // Cache projeté : seuls ws et wb sont copiés, dans fPData.
+    if (!opts.biasFile.empty() && opts.sampler != Sampler::Reservoir) {
+        std::vector<BiasBin> bins;
+        std::string err;
+        if (!read_bias_spectrum(opts.biasFile, bins, err)) {
+            G4Exception("ParticleSource", "BadBiasSpectrum",
+                        FatalErrorInArgument, err.c_str());
+            return false;
+        }
+        apply_energy_bias(fView, bins, fPData.ws, fPData.wb);
+        if (fPData.ws.size() == fView.px.size()) {
+            fView.ws = fPData.ws;
+            fView.wb = fPData.wb;
+        }
+        fTable.Clear();
+    }
+
+    // 5) Fiches de tirage, une fois les poids définitifs (déjà prêtes si
+    // elles viennent du cache ou de son écriture, sans biais)
+    if (fTable.Empty()) fTable.Build(fView);
+    return true;
+}
+
+void ParticleSource::SetSeed(std::uint64_t seed)
+{
+    fSeed = seed;
+    if (seed != 0) fGen.seed(static_cast<std::mt19937::result_type>(stream_seed(seed, 0)));
+}
+
+void ParticleSource::PrepareRun(std::uint64_t nEvents, Sampler sampler)
+{
+    // Index de tirages précalculé, consommé dans l'ordre des événements
+    fIndex.clear();
+    // Colonnes de fView : celles de fPData après lecture, celles du cache projeté sinon
+    if (sampler != Sampler::Random && !fView.px.empty()) {
+        ScopeTimer timer(Stage::Prepare);
+        fIndex = build_sample_index(fView, static_cast<std::size_t>(nEvents), sampler, fGen);
+    }
+}
+
+} // namespace wxg4
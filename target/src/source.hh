@@ -0,0 +1,93 @@
+// src/source.hh
+#ifndef SOURCE_HH
+#define SOURCE_HH
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "read.hh"
+#include "options.hh"
+#include "primary.hh"
+#include "cache.hh"
+
+class G4ParticleDefinition;
+namespace openPMD { class Series; class Iteration; }
+
+namespace wxg4
+{
+
+/**
+ * Particules primaires du processus : lecture OpenPMD (ou cache) de la
+ * tranche du shard, filtrage, tri, biais, puis index de tirages par run.
+ * Chargé par le thread maître entre deux runs et lu sans verrou par les
+ * générateurs de tous les threads pendant le run. Depuis le cache, les
+ * colonnes et les fiches de tirage sont lues en place dans la projection ;
+ * seuls ws et wb sont copiés quand --bias les modifie.
+ */
+class ParticleSource
+{
+public:
+    ParticleSource() : fGen{std::random_device{}()} {}
+
+    /**
+     * (Re)charge les données décrites par opts (dataset, espèces,
+     * itération, tri, biais), et écrit le cache si opts.cacheDir est
+     * donné. series : série déjà ouverte, ou nullptr pour ouvrir
+     * opts.dataset. step : itération d'un flux déjà ouverte (--stream),
+     * lue telle quelle, sans cache.
+     * @return false si une espèce ou le spectre de biais est invalide
+     */
+    bool Load(const RunOptions& opts, openPMD::Series* series,
+              openPMD::Iteration* step = nullptr);
+
+    /**
+     * Charge les données depuis le cache de opts.cacheDir, sans ouvrir la
+     * série openPMD (à essayer avant Load).
+     * @return false si le cache est absent ou ne correspond pas (réservoir :
+     *         jamais de cache), ou si le spectre de biais est invalide
+     */
+    bool LoadCached(const RunOptions& opts);
+
+    /// Index de nEvents tirages pour le prochain run (vide si sampler = random)
+    void PrepareRun(std::uint64_t nEvents, Sampler sampler);
+
+    /**
+     * Graine du processus (shard) : index de tirages reproductibles, et
+     * base des flux des générateurs. 0 = graines aléatoires (défaut).
+     */
+    void SetSeed(std::uint64_t seed);
+    std::uint64_t Seed() const { return fSeed; }
+
+    bool Empty() const { return fView.px.empty(); }
+    /// Enregistrements lus avant filtrage, toutes espèces (tranche du shard)
+    std::uint64_t Records() const { return fRecords; }
+    /// Colonnes des particules : stockage propre ou cache projeté
+    const ParticleView&                       Data()        const { return fView; }
+    const std::vector<G4ParticleDefinition*>& Definitions() const { return fDefs; }
+    const std::vector<std::uint32_t>&         Index()       const { return fIndex; }
+    /// Fiches de tirage (direction, |p|, alias), une par particule de Data()
+    const PrimaryTable&                       Table()       const { return fTable; }
+
+private:
+    /// Vide la source (stockage, projection, fiches, index)
+    void Reset();
+    /// Particule Geant4 et masse de chaque espèce ; false si inconnue
+    bool ResolveSpecies(const RunOptions& opts, std::vector<double>& masses_MeV);
+    /// Biais éventuel puis fiches de tirage, une fois les colonnes en place
+    bool Finish(const RunOptions& opts);
+
+    ParticleData                       fPData;   // px,py,pz, ws et sid (ws et wb seuls si projeté)
+    ParticleCacheMap                   fMap;     // cache projeté (fermé si lecture openPMD)
+    ParticleView                       fView;    // colonnes en usage (fPData ou fMap)
+    std::uint64_t                      fRecords = 0;
+    std::vector<G4ParticleDefinition*> fDefs;    // particule Geant4 par espèce
+    std::vector<std::uint32_t>         fIndex;   // tirages précalculés (vide = aléatoire)
+    PrimaryTable                       fTable;   // fiches de 32 octets pour GeneratePrimaries
+    std::mt19937                       fGen;     // décalages des index
+    std::uint64_t                      fSeed = 0;
+};
+
+} // namespace wxg4
+
+#endif // SOURCE_HH
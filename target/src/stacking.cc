@@ -0,0 +1,38 @@
+// src/stacking.cc
+#include "stacking.hh"
+
+#include <G4Track.hh>
+#include <G4ParticleDefinition.hh>
+
+#include <cmath>
+
+#include "construction.hh"
+#include "run.hh"
+
+MyStackingAction::MyStackingAction(const KillCuts& cuts, MyRunAction* runAction)
+: fCuts(cuts)
+, fRunAction(runAction)
+{}
+
+G4ClassificationOfNewTrack MyStackingAction::ClassifyNewTrack(const G4Track* track)
+{
+    if (fCuts.emin > 0. && track->GetKineticEnergy() < fCuts.emin) {
+        fRunAction->CountKilledTrack();
+        return fKill;
+    }
+
+    // Le volume n'est pas encore connu à ce stade : on teste la position.
+    // Dans la cible, la trace peut diffuser, on la garde ; instable, ses
+    // produits de désintégration peuvent atteindre les pixels.
+    using DC = MyDetectorConstruction;
+    const G4ThreeVector pos = track->GetPosition();
+    const bool inTarget = std::abs(pos.x()) <= DC::kTargetHalfXY
+                       && std::abs(pos.y()) <= DC::kTargetHalfXY
+                       && std::abs(pos.z() - DC::kTargetZ) <= 0.5*fCuts.detector->GetThickness();
+    if (!inTarget && track->GetDefinition()->GetPDGStable()
+        && !CanReachDetector(fCuts, pos, track->GetMomentumDirection())) {
+        fRunAction->CountKilledTrack();
+        return fKill;
+    }
+    return fUrgent;
+}
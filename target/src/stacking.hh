@@ -0,0 +1,26 @@
+// src/stacking.hh
+#ifndef STACKING_HH
+#define STACKING_HH
+
+#include <G4UserStackingAction.hh>
+
+#include "stepping.hh"
+
+class MyRunAction;
+
+/// Refuse dès leur création les traces trop lentes, ou nées dans le vide
+/// sans pouvoir atteindre les pixels
+class MyStackingAction : public G4UserStackingAction
+{
+public:
+    MyStackingAction(const KillCuts& cuts, MyRunAction* runAction);
+    ~MyStackingAction() override = default;
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+
+private:
+    KillCuts     fCuts;
+    MyRunAction* fRunAction;
+};
+
+#endif // STACKING_HH
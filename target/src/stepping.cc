@@ -0,0 +1,101 @@
+// src/stepping.cc
+#include "stepping.hh"
+
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4Track.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4VTouchable.hh>
+#include <geomdefs.hh>
+
+#include <algorithm>
+
+#include "construction.hh"
+#include "run.hh"
+
+namespace
+{
+
+// Test rayon / boîte alignée (méthode des tranches) pour t > 0
+bool RayHitsBox(const G4ThreeVector& pos, const G4ThreeVector& dir,
+                const G4ThreeVector& lo, const G4ThreeVector& hi)
+{
+    G4double tmin = 0.;
+    G4double tmax = kInfinity;
+    const G4double p[3]  = { pos.x(), pos.y(), pos.z() };
+    const G4double d[3]  = { dir.x(), dir.y(), dir.z() };
+    const G4double l[3]  = { lo.x(),  lo.y(),  lo.z()  };
+    const G4double h[3]  = { hi.x(),  hi.y(),  hi.z()  };
+    for (int a = 0; a < 3; ++a) {
+        if (d[a] == 0.) {
+            if (p[a] < l[a] || p[a] > h[a]) return false;
+            continue;
+        }
+        G4double t0 = (l[a] - p[a]) / d[a];
+        G4double t1 = (h[a] - p[a]) / d[a];
+        if (t0 > t1) std::swap(t0, t1);
+        tmin = std::max(tmin, t0);
+        tmax = std::min(tmax, t1);
+        if (tmin > tmax) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool CanReachDetector(const KillCuts& cuts,
+                      const G4ThreeVector& pos,
+                      const G4ThreeVector& dir)
+{
+    using DC = MyDetectorConstruction;
+
+    if (cuts.cosCone > -1. && dir.z() < cuts.cosCone) return false;
+    if (!cuts.geometry) return true;
+
+    // Plan de pixels : couvre toute la section du monde
+    const G4ThreeVector detLo(-DC::kWorldHalf, -DC::kWorldHalf, DC::kDetectorZ - DC::kPixelHalf);
+    const G4ThreeVector detHi( DC::kWorldHalf,  DC::kWorldHalf, DC::kDetectorZ + DC::kPixelHalf);
+    if (RayHitsBox(pos, dir, detLo, detHi)) return true;
+
+    // Cible : une trace qui y retourne peut encore être diffusée vers l'avant
+    const G4double halfZ = 0.5*cuts.detector->GetThickness();
+    const G4ThreeVector tgtLo(-DC::kTargetHalfXY, -DC::kTargetHalfXY, DC::kTargetZ - halfZ);
+    const G4ThreeVector tgtHi( DC::kTargetHalfXY,  DC::kTargetHalfXY, DC::kTargetZ + halfZ);
+    return RayHitsBox(pos, dir, tgtLo, tgtHi);
+}
+
+MySteppingAction::MySteppingAction(const KillCuts& cuts, MyRunAction* runAction,
+                                   wxg4::VolumeProfiler* volumes)
+: fCuts(cuts)
+, fKill(cuts.geometry || cuts.emin > 0. || cuts.cosCone > -1.)
+, fRunAction(runAction)
+, fVolumes(volumes)
+{}
+
+void MySteppingAction::UserSteppingAction(const G4Step* step)
+{
+    if (fVolumes) fVolumes->Record(step);
+    if (!fKill) return;
+
+    const G4StepPoint* post = step->GetPostStepPoint();
+    G4Track* track = step->GetTrack();
+
+    // Plancher en énergie, partout
+    if (fCuts.emin > 0. && post->GetKineticEnergy() < fCuts.emin) {
+        track->SetTrackStatus(fStopAndKill);
+        fRunAction->CountKilledTrack();
+        return;
+    }
+
+    // Entrée dans le monde (profondeur 0) depuis un volume fille :
+    // la suite du trajet est rectiligne, on décide une fois pour toutes
+    if (post->GetStepStatus() != fGeomBoundary) return;
+    if (post->GetTouchable()->GetHistoryDepth() != 0) return;
+
+    // Instable : ses produits de désintégration peuvent repartir vers les pixels
+    if (!track->GetDefinition()->GetPDGStable()) return;
+    if (!CanReachDetector(fCuts, post->GetPosition(), post->GetMomentumDirection())) {
+        track->SetTrackStatus(fStopAndKill);
+        fRunAction->CountKilledTrack();
+    }
+}
@@ -0,0 +1,57 @@
+// src/stepping.hh
+#ifndef STEPPING_HH
+#define STEPPING_HH
+
+#include <G4UserSteppingAction.hh>
+#include <G4ThreeVector.hh>
+
+#include <memory>
+
+#include "volumes.hh"
+
+class MyRunAction;
+class MyDetectorConstruction;
+
+/// Critères d'arrêt anticipé des traces (unités Geant4)
+struct KillCuts {
+    bool     geometry  = false; // tuer ce qui ne peut plus atteindre les pixels
+    G4double emin      = 0.;    // énergie cinétique plancher (0 = désactivé)
+    G4double cosCone   = -1.;   // cos du demi-angle du cône autour de +z (-1 = désactivé)
+    // Épaisseur de la cible lue à chaque test : elle change entre les runs d'un balayage
+    const MyDetectorConstruction* detector = nullptr;
+};
+
+/**
+ * Vrai si une trace en ligne droite depuis pos, selon dir, peut encore
+ * produire un hit : elle croise le plan de pixels, ou repasse par la
+ * cible (où elle peut diffuser). Le monde est vide et sans champ, donc
+ * hors cible les trajectoires sont rectilignes. Ne vaut que pour une
+ * particule stable : les appelants épargnent les instables, dont les
+ * produits de désintégration peuvent repartir vers les pixels.
+ */
+bool CanReachDetector(const KillCuts& cuts,
+                      const G4ThreeVector& pos,
+                      const G4ThreeVector& dir);
+
+/**
+ * Arrête les traces qui sortent de la cible sans pouvoir atteindre les
+ * pixels et, si volumes n'est pas nul, tient le profil par volume
+ * (l'action en devient propriétaire).
+ */
+class MySteppingAction : public G4UserSteppingAction
+{
+public:
+    MySteppingAction(const KillCuts& cuts, MyRunAction* runAction,
+                     wxg4::VolumeProfiler* volumes = nullptr);
+    ~MySteppingAction() override = default;
+
+    void UserSteppingAction(const G4Step* step) override;
+
+private:
+    KillCuts     fCuts;
+    bool         fKill;        // au moins un critère d'arrêt actif
+    MyRunAction* fRunAction;
+    std::unique_ptr<wxg4::VolumeProfiler> fVolumes;
+};
+
+#endif // STEPPING_HH
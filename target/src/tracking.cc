@@ -0,0 +1,13 @@
+// src/tracking.cc
+#include "tracking.hh"
+
+#include <G4Track.hh>
+
+#include "profiler.hh"
+
+void MyTrackingAction::PostUserTrackingAction(const G4Track* track)
+{
+    auto& prof = wxg4::Profiler::Instance();
+    prof.Add(wxg4::Counter::Tracks);
+    prof.Add(wxg4::Counter::Steps, static_cast<std::uint64_t>(track->GetCurrentStepNumber()));
+}
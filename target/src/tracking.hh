@@ -0,0 +1,17 @@
+// src/tracking.hh
+#ifndef TRACKING_HH
+#define TRACKING_HH
+
+#include <G4UserTrackingAction.hh>
+
+/// Compte traces et pas (un appel par trace, pas par pas)
+class MyTrackingAction : public G4UserTrackingAction
+{
+public:
+    MyTrackingAction() = default;
+    ~MyTrackingAction() override = default;
+
+    void PostUserTrackingAction(const G4Track* track) override;
+};
+
+#endif // TRACKING_HH
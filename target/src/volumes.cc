@@ -0,0 +1,162 @@
+// src/volumes.cc
+#include "volumes.hh"
+
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4Track.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+namespace wxg4
+{
+
+namespace
+{
+
+using Key = std::pair<const G4LogicalVolume*, const G4ParticleDefinition*>;
+
+std::mutex                               gMutex;
+std::map<Key, VolumeProfiler::Stats>     gTotal;
+
+/// Temps extrapolé à tous les pas de l'entrée
+double estimated_seconds(const VolumeProfiler::Stats& s)
+{
+    return s.timedSteps ? s.timedSeconds * double(s.steps) / double(s.timedSteps) : 0.;
+}
+
+} // namespace
+
+VolumeProfiler::VolumeProfiler(unsigned period)
+: fPeriod(period)
+{}
+
+VolumeProfiler::Stats& VolumeProfiler::Find(const G4LogicalVolume* lv,
+                                            const G4ParticleDefinition* def)
+{
+    if (fLast < fEntries.size()
+        && fEntries[fLast].volume == lv && fEntries[fLast].particle == def) {
+        return fEntries[fLast].stats;
+    }
+    for (std::size_t i = 0; i < fEntries.size(); ++i) {
+        if (fEntries[i].volume == lv && fEntries[i].particle == def) {
+            fLast = i;
+            return fEntries[i].stats;
+        }
+    }
+    fEntries.push_back({lv, def, {}});
+    fLast = fEntries.size() - 1;
+    return fEntries.back().stats;
+}
+
+void VolumeProfiler::Record(const G4Step* step)
+{
+    const G4Track* track = step->GetTrack();
+    const G4VPhysicalVolume* pv = step->GetPreStepPoint()->GetPhysicalVolume();
+    Stats& s = Find(pv ? pv->GetLogicalVolume() : nullptr, track->GetDefinition());
+
+    ++s.steps;
+    s.length += step->GetStepLength();
+
+    if (fPeriod == 0) return;
+
+    // Le pas chronométré va du pas précédent (fMark) à celui-ci ;
+    // ignoré si la trace a changé entre-temps (coût de suivi, pas de
+    // transport), y compris une nouvelle trace allouée à la même adresse
+    if (fArmed) {
+        if (track == fTimedTrack && track->GetTrackID() == fTimedTrackID) {
+            const std::chrono::duration<double> dt =
+                std::chrono::steady_clock::now() - fMark;
+            ++s.timedSteps;
+            s.timedSeconds += dt.count();
+        }
+        fArmed = false;
+    }
+    if (++fCount % fPeriod == 0) {
+        fArmed        = true;
+        fTimedTrack   = track;
+        fTimedTrackID = track->GetTrackID();
+        fMark         = std::chrono::steady_clock::now();
+    }
+}
+
+void VolumeProfiler::Flush()
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    for (const auto& e : fEntries) {
+        Stats& t = gTotal[{e.volume, e.particle}];
+        t.steps        += e.stats.steps;
+        t.length       += e.stats.length;
+        t.timedSteps   += e.stats.timedSteps;
+        t.timedSeconds += e.stats.timedSeconds;
+    }
+    fEntries.clear();
+    fLast   = 0;
+    fArmed  = false;
+}
+
+void VolumeProfiler::Report(std::ostream& os, const std::string& csvPath)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (gTotal.empty()) return;
+
+    std::vector<std::pair<Key, Stats>> rows(gTotal.begin(), gTotal.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        if (estimated_seconds(a.second) != estimated_seconds(b.second)) {
+            return estimated_seconds(a.second) > estimated_seconds(b.second);
+        }
+        return a.second.steps > b.second.steps;
+    });
+
+    std::uint64_t steps = 0;
+    double        time  = 0.;
+    for (const auto& r : rows) {
+        steps += r.second.steps;
+        time  += estimated_seconds(r.second);
+    }
+
+    auto volumeName = [](const G4LogicalVolume* lv) {
+        return lv ? std::string(lv->GetName()) : std::string("?");
+    };
+    auto particleName = [](const G4ParticleDefinition* def) {
+        return def ? std::string(def->GetParticleName()) : std::string("?");
+    };
+
+    os << "[VolumeProfiler] " << steps << " pas, ~" << time
+       << " s de transport estimés\n";
+    for (const auto& r : rows) {
+        const Stats& s = r.second;
+        const double t = estimated_seconds(s);
+        os << "[VolumeProfiler]   " << volumeName(r.first.first)
+           << " / " << particleName(r.first.second)
+           << " : " << s.steps << " pas (" << 100. * s.steps / steps << " %), "
+           << s.length / m << " m, ~" << t << " s";
+        if (time > 0.) os << " (" << 100. * t / time << " %)";
+        os << "\n";
+    }
+
+    if (!csvPath.empty()) {
+        std::ofstream out(csvPath);
+        out.precision(9);
+        out << "volume,particle,steps,length_mm,timed_steps,timed_s,estimated_s\n";
+        for (const auto& r : rows) {
+            const Stats& s = r.second;
+            out << volumeName(r.first.first) << "," << particleName(r.first.second)
+                << "," << s.steps << "," << s.length / mm
+                << "," << s.timedSteps << "," << s.timedSeconds
+                << "," << estimated_seconds(s) << "\n";
+        }
+        os << "[VolumeProfiler] Table écrite dans " << csvPath << "\n";
+    }
+    gTotal.clear();
+}
+
+} // namespace wxg4
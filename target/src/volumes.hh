@@ -0,0 +1,76 @@
+// src/volumes.hh
+#ifndef VOLUMES_HH
+#define VOLUMES_HH
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class G4Step;
+class G4Track;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+
+namespace wxg4
+{
+
+/**
+ * Pas, longueur parcourue et temps réel par volume logique et par
+ * particule. Une instance par thread (celle du SteppingAction) : aucun
+ * verrou pendant la boucle. Le temps n'est mesuré qu'un pas sur `period`
+ * (deux lectures d'horloge) puis extrapolé au nombre de pas du volume.
+ * Flush() verse la table dans le total commun en fin de run.
+ */
+class VolumeProfiler
+{
+public:
+    explicit VolumeProfiler(unsigned period);
+
+    void Record(const G4Step* step);
+    /// Début d'événement : le pas chronométré en cours est abandonné
+    void BeginEvent() { fArmed = false; }
+
+    /// Ajoute la table de ce thread au total commun, puis la vide
+    void Flush();
+
+    /**
+     * Affiche le total commun trié par temps estimé, l'écrit en CSV si
+     * csvPath n'est pas vide, puis le vide. Sans effet si rien n'a été
+     * enregistré (profilage désactivé).
+     */
+    static void Report(std::ostream& os, const std::string& csvPath);
+
+    struct Stats {
+        std::uint64_t steps        = 0;
+        double        length       = 0.;  // mm
+        std::uint64_t timedSteps   = 0;
+        double        timedSeconds = 0.;
+    };
+
+private:
+    struct Entry {
+        const G4LogicalVolume*      volume;
+        const G4ParticleDefinition* particle;
+        Stats                       stats;
+    };
+
+    Stats& Find(const G4LogicalVolume* lv, const G4ParticleDefinition* def);
+
+    std::vector<Entry> fEntries;     // peu d'entrées : recherche linéaire
+    std::size_t        fLast = 0;    // dernière entrée touchée
+    unsigned           fPeriod;
+    std::uint64_t      fCount = 0;
+
+    // Pas chronométré en cours : instant de départ et trace concernée
+    // (adresse et numéro : les G4Track sont recyclés par un pool)
+    bool                                  fArmed = false;
+    const G4Track*                        fTimedTrack = nullptr;
+    int                                   fTimedTrackID = -1;
+    std::chrono::steady_clock::time_point fMark;
+};
+
+} // namespace wxg4
+
+#endif // VOLUMES_HH
@@ -0,0 +1,250 @@
+// tools/analyse.cc
+//
+// Analyse des sorties de read_warpx_particles (ntuple "momenta") sans
+// charger le fichier en mémoire : les lignes sont lues par blocs, les
+// grandeurs (p, T, angles) calculées et histogrammées par N threads
+// pendant la lecture du bloc suivant. Remplace le DataFrame pandas de
+// analyse_output.ipynb ; mémoire bornée par deux blocs, quelle que soit
+// la taille des fichiers.
+//
+//   analyse_hits <output.root>... [--out dir] [--mass MeV] [--tmin MeV]
+//                [--energy lo:hi:n] [--theta lo:hi:n] [--pxz lo:hi:n]
+//                [--threads N] [--chunk lignes]
+//
+// Plusieurs fichiers (shards fusionnés, itérations d'un flux) sont
+// cumulés dans les mêmes histogrammes. Sorties CSV dans <dir> :
+//   p.csv, T.csv (bins log), theta.csv, phi.csv       1D, pondérés
+//   px_pz.csv, T_theta.csv                            2D, bins non vides
+// Impulsions du ntuple en MeV/c ; --mass : masse supposée des hits pour T
+// (défaut électron, le ntuple ne porte pas l'espèce).
+
+#include <G4RootAnalysisReader.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "histogram.hh"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr double kRadToDeg = 180. / 3.14159265358979323846;
+
+/// Bloc de lignes du ntuple, en colonnes
+struct Chunk {
+    std::vector<double> px, py, pz, w;
+
+    void Clear() { px.clear(); py.clear(); pz.clear(); w.clear(); }
+    std::size_t Size() const { return px.size(); }
+};
+
+/// Histogrammes d'un thread, fusionnés en fin de lecture
+struct Histograms {
+    wxg4::Hist1D p, T, theta, phi;
+    wxg4::Hist2D pxpz, Ttheta;
+    std::uint64_t rows = 0, kept = 0;
+    double weight = 0., sumT = 0.;
+
+    void Add(const Histograms& o)
+    {
+        p.Add(o.p); T.Add(o.T); theta.Add(o.theta); phi.Add(o.phi);
+        pxpz.Add(o.pxpz); Ttheta.Add(o.Ttheta);
+        rows += o.rows; kept += o.kept; weight += o.weight; sumT += o.sumT;
+    }
+};
+
+struct Config {
+    std::string   outDir = "analysis";
+    double        mass   = 0.51099895;   // MeV
+    double        tmin   = 0.;           // MeV, hits en dessous ignorés
+    wxg4::BinSpec energy{0.1, 1e5, 120};   // p et T, log
+    wxg4::BinSpec theta{0., 180., 180};    // deg / +z
+    wxg4::BinSpec pxz{-1000., 1000., 200}; // px et pz, MeV/c
+    unsigned      threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t   chunk   = 1u << 20;
+};
+
+/// Tranche [first, last) du bloc, dans les histogrammes du thread
+void fill(const Chunk& c, std::size_t first, std::size_t last, double mass, double tmin, Histograms& h)
+{
+    for (std::size_t i = first; i < last; ++i) {
+        const double px = c.px[i], py = c.py[i], pz = c.pz[i], w = c.w[i];
+        const double p = std::sqrt(px * px + py * py + pz * pz);
+        const double T = std::sqrt(p * p + mass * mass) - mass;
+        ++h.rows;
+        if (T < tmin) continue;
+        const double theta = p > 0. ? std::acos(std::clamp(pz / p, -1., 1.)) * kRadToDeg : 0.;
+        const double phi   = std::atan2(py, px) * kRadToDeg;
+        h.p.Fill(p, w);
+        h.T.Fill(T, w);
+        h.theta.Fill(theta, w);
+        h.phi.Fill(phi, w);
+        h.pxpz.Fill(px, pz, w);
+        h.Ttheta.Fill(T, theta, w);
+        ++h.kept;
+        h.weight += w;
+        h.sumT   += w * T;
+    }
+}
+
+/// Bloc réparti entre les threads, chacun dans ses histogrammes
+void fill_parallel(const Chunk& c, const Config& cfg, std::vector<Histograms>& perThread)
+{
+    const std::size_t n = c.Size(), nt = perThread.size();
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < nt; ++t) {
+        workers.emplace_back(fill, std::cref(c), n * t / nt, n * (t + 1) / nt,
+                             cfg.mass, cfg.tmin, std::ref(perThread[t]));
+    }
+    fill(c, 0, n / nt, cfg.mass, cfg.tmin, perThread[0]);
+    for (auto& w : workers) w.join();
+}
+
+bool parse_axis(const std::string& opt, const char* value, wxg4::BinSpec& spec)
+{
+    if (wxg4::parse_bin_spec(value, spec)) return true;
+    std::cerr << "[analyse] " << opt << " expects lo:hi:n with lo < hi and n >= 1 (got '"
+              << value << "')\n";
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Config cfg;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) {
+            cfg.outDir = argv[++i];
+        } else if (arg == "--mass" && hasValue) {
+            cfg.mass = std::atof(argv[++i]);
+        } else if (arg == "--tmin" && hasValue) {
+            cfg.tmin = std::atof(argv[++i]);
+        } else if (arg == "--energy" && hasValue) {
+            if (!parse_axis(arg, argv[++i], cfg.energy)) return 1;
+        } else if (arg == "--theta" && hasValue) {
+            if (!parse_axis(arg, argv[++i], cfg.theta)) return 1;
+        } else if (arg == "--pxz" && hasValue) {
+            if (!parse_axis(arg, argv[++i], cfg.pxz)) return 1;
+        } else if (arg == "--threads" && hasValue) {
+            cfg.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--chunk" && hasValue) {
+            cfg.chunk = static_cast<std::size_t>(std::max(1L, std::atol(argv[++i])));
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::fprintf(stderr,
+            "Usage: %s <output.root>... [--out dir] [--mass MeV] [--tmin MeV]\n"
+            "          [--energy lo:hi:n] [--theta lo:hi:n] [--pxz lo:hi:n]\n"
+            "          [--threads N] [--chunk lignes]\n",
+            argv[0]);
+        return 1;
+    }
+
+    // Histogrammes vides d'un thread, copiés pour les autres
+    Histograms proto;
+    const wxg4::HistAxis energy(cfg.energy, true), theta(cfg.theta, false),
+                         phi(wxg4::BinSpec{-180., 180., 72}, false), pxz(cfg.pxz, false);
+    proto.p      = wxg4::Hist1D(energy);
+    proto.T      = wxg4::Hist1D(energy);
+    proto.theta  = wxg4::Hist1D(theta);
+    proto.phi    = wxg4::Hist1D(phi);
+    proto.pxpz   = wxg4::Hist2D(pxz, pxz);
+    proto.Ttheta = wxg4::Hist2D(energy, theta);
+    std::vector<Histograms> perThread(cfg.threads, proto);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    auto* reader = G4RootAnalysisReader::Instance();
+    reader->SetVerboseLevel(0);
+
+    // Double tampon : le bloc k est histogrammé pendant la lecture du bloc k+1
+    Chunk buffers[2];
+    int current = 0;
+    std::future<void> pending;
+    auto submit = [&](Chunk& c) {
+        if (pending.valid()) pending.get();
+        pending = std::async(std::launch::async, fill_parallel, std::cref(c), std::cref(cfg),
+                             std::ref(perThread));
+    };
+    auto reserve = [&](Chunk& c) {
+        c.px.reserve(cfg.chunk); c.py.reserve(cfg.chunk);
+        c.pz.reserve(cfg.chunk); c.w.reserve(cfg.chunk);
+    };
+    reserve(buffers[0]);
+    reserve(buffers[1]);
+
+    for (const auto& path : inputs) {
+        const G4int id = reader->GetNtuple("momenta", path);
+        if (id < 0) {
+            std::cerr << "[analyse] no 'momenta' ntuple in " << path << "\n";
+            return 1;
+        }
+        G4double px = 0., py = 0., pz = 0., w = 0.;
+        reader->SetNtupleDColumn(id, "px", px);
+        reader->SetNtupleDColumn(id, "py", py);
+        reader->SetNtupleDColumn(id, "pz", pz);
+        reader->SetNtupleDColumn(id, "weight", w);
+
+        while (reader->GetNtupleRow(id)) {
+            Chunk& c = buffers[current];
+            c.px.push_back(px);
+            c.py.push_back(py);
+            c.pz.push_back(pz);
+            c.w.push_back(w);
+            if (c.Size() == cfg.chunk) {
+                submit(c);
+                current ^= 1;
+                // Autre tampon : submit a attendu la fin de son bloc
+                buffers[current].Clear();
+            }
+        }
+        std::cout << "[analyse] " << path << " lu\n";
+    }
+    if (buffers[current].Size() > 0) submit(buffers[current]);
+    if (pending.valid()) pending.get();
+
+    Histograms total = perThread[0];
+    for (std::size_t t = 1; t < perThread.size(); ++t) total.Add(perThread[t]);
+    const double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    std::error_code ec;
+    fs::create_directories(cfg.outDir, ec);
+    const auto out = [&](const char* name) { return (fs::path(cfg.outDir) / name).string(); };
+    const std::string cut = cfg.tmin > 0. ? ", T >= " + std::to_string(cfg.tmin) + " MeV" : "";
+    std::string err;
+    const bool ok =
+        total.p.WriteCsv(out("p.csv"), "p [MeV/c]" + cut, err)
+        && total.T.WriteCsv(out("T.csv"), "T [MeV], m = " + std::to_string(cfg.mass) + " MeV" + cut, err)
+        && total.theta.WriteCsv(out("theta.csv"), "theta / +z [deg]" + cut, err)
+        && total.phi.WriteCsv(out("phi.csv"), "phi [deg]" + cut, err)
+        && total.pxpz.WriteCsv(out("px_pz.csv"), "px [MeV/c] x pz [MeV/c]" + cut, err)
+        && total.Ttheta.WriteCsv(out("T_theta.csv"), "T [MeV] x theta [deg]" + cut, err);
+    if (!ok) {
+        std::cerr << "[analyse] " << err << "\n";
+        return 1;
+    }
+
+    std::cout << "[analyse] " << inputs.size() << " fichier(s), " << total.rows << " hits, "
+              << total.kept << " retenus, poids " << total.weight << ", <T> pondéré "
+              << (total.weight > 0. ? total.sumT / total.weight : 0.) << " MeV\n"
+              << "[analyse] " << ms << " ms (" << cfg.threads << " threads, blocs de "
+              << cfg.chunk << " lignes) -> " << cfg.outDir << "/\n";
+    return 0;
+}
@@ -0,0 +1,116 @@
+// tools/fold.cc
+//
+// Plie une itération WarpX par une matrice de réponse du détecteur
+// (read_warpx_particles --response) : hits attendus par famille, rayon et
+// énergie sur le plan des pixels, sans relancer Geant4.
+//
+//   fold_response <matrice> <openPMD_path> <species[,species...]> <iteration>
+//                 [--out folded.csv]
+//
+// Toutes les espèces listées sont pliées avec la même matrice (même
+// particule primaire) ; pour plusieurs particules, une matrice chacune
+// et un appel par matrice.
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "read.hh"
+#include "response.hh"
+
+namespace
+{
+
+double elapsed_ms(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> positional;
+    std::string outPath = "folded.csv";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 4) {
+        std::fprintf(stderr,
+            "Usage: %s <matrice> <openPMD_path> <species[,species...]> <iteration> [--out folded.csv]\n",
+            argv[0]);
+        return 1;
+    }
+
+    wxg4::ResponseMatrix matrix;
+    std::string err;
+    if (!matrix.Load(positional[0], err)) {
+        std::cerr << "[fold] " << err << "\n";
+        return 1;
+    }
+    const auto& bins = matrix.Binning();
+    std::cout << "[fold] Matrice " << positional[0] << " : " << matrix.Particle() << ", "
+              << bins.NEnergy() << " x " << bins.NTheta() << " bins d'entrée ("
+              << bins.energy.front() << "-" << bins.energy.back() << " MeV, "
+              << bins.theta.front() << "-" << bins.theta.back() << " deg)\n";
+
+    const auto species = wxg4::parse_species_list(positional[2]);
+    for (const auto& sp : species) {
+        if (!sp.g4name.empty() && sp.g4name != matrix.Particle()) {
+            std::cerr << "[fold] Attention : espèce " << sp.name << " (" << sp.g4name
+                      << ") pliée avec une matrice " << matrix.Particle() << "\n";
+        }
+    }
+
+    // Lecture, puis énergie cinétique avec la masse de la particule de la matrice
+    auto t0 = std::chrono::steady_clock::now();
+    wxg4::ParticleData pdata;
+    try {
+        pdata = wxg4::read_particle_data_3d(positional[1], species, std::stoi(positional[3]));
+    } catch (const std::exception& e) {
+        std::cerr << "[fold] openPMD : " << e.what() << "\n";
+        return 1;
+    }
+    wxg4::filter_kinetic_energy(pdata, std::vector<double>(species.size(), matrix.Mass()), 0.0);
+    const double readMs = elapsed_ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    const auto folded = matrix.Fold(pdata);
+    const double foldMs = elapsed_ms(t0);
+
+    double total = 0.;
+    std::vector<double> perClass(static_cast<std::size_t>(wxg4::HitClass::kCount), 0.);
+    const std::size_t perClassBins = bins.NOut() / perClass.size();
+    for (std::size_t i = 0; i < folded.hits.size(); ++i) {
+        total += folded.hits[i];
+        perClass[i / perClassBins] += folded.hits[i];
+    }
+
+    std::cout << "[fold] " << pdata.px.size() << " particules, poids plié " << folded.inside
+              << " | sous " << bins.energy.front() << " MeV : " << folded.underflow
+              << " | hors domaine : " << folded.overflow << "\n";
+    std::cout << "[fold] Hits attendus : " << total;
+    for (std::size_t c = 0; c < perClass.size(); ++c) {
+        std::cout << " | " << wxg4::hit_class_name(static_cast<wxg4::HitClass>(c))
+                  << " " << perClass[c];
+    }
+    std::cout << "\n[fold] Lecture " << readMs << " ms, pliage " << foldMs << " ms\n";
+
+    std::ofstream out(outPath);
+    if (!out) {
+        std::cerr << "[fold] Impossible d'écrire " << outPath << "\n";
+        return 1;
+    }
+    wxg4::ResponseMatrix::WriteCsv(out, bins, folded.hits);
+    std::cout << "[fold] Résultat : " << outPath << "\n";
+    return 0;
+}
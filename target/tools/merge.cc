@@ -0,0 +1,117 @@
+// tools/merge.cc
+//
+// Recombine les sorties d'un run découpé en shards (read_warpx_particles
+// --shard k/N) en un seul ntuple "momenta", statistiquement équivalent à
+// un run unique : les poids des hits de chaque shard sont multipliés par
+// (poids de sa tranche / ses événements) / (poids total / événements
+// totaux), les eventID décalés pour rester uniques.
+//
+//   merge_shards <merged.root> <output_shard0of4.shard> ... <output_shard3of4.shard>
+//
+// Les fichiers de hits sont cherchés à côté de leur bilan .shard.
+
+#include <G4AnalysisManager.hh>
+#include <G4RootAnalysisReader.hh>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "shard.hh"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <merged.root> <shard summary>...\n", argv[0]);
+        return 1;
+    }
+    const std::string outPath = argv[1];
+
+    // 1) Bilans, dans l'ordre des shards
+    std::vector<wxg4::ShardSummary> shards;
+    std::string err;
+    for (int i = 2; i < argc; ++i) {
+        wxg4::ShardSummary s;
+        if (!wxg4::read_shard_summary(argv[i], s, err)) {
+            std::cerr << "[merge] " << err << "\n";
+            return 1;
+        }
+        s.output = (fs::path(argv[i]).parent_path() / fs::path(s.output).filename()).string();
+        shards.push_back(s);
+    }
+    std::sort(shards.begin(), shards.end(),
+              [](const auto& a, const auto& b) { return a.shard.index < b.shard.index; });
+    std::vector<double> factors;
+    if (!wxg4::shard_weight_factors(shards, factors, err)) {
+        std::cerr << "[merge] " << err << "\n";
+        return 1;
+    }
+
+    // 2) Ntuple fusionné, mêmes colonnes que MyRunAction
+    auto* man = G4AnalysisManager::Instance();
+    man->SetDefaultFileType("root");
+    man->SetVerboseLevel(0);
+    if (!man->OpenFile(outPath)) {
+        std::cerr << "[merge] cannot create " << outPath << "\n";
+        return 1;
+    }
+    man->CreateNtuple("momenta", "Particle Momenta");
+    man->CreateNtupleIColumn("eventID");
+    man->CreateNtupleDColumn("px");
+    man->CreateNtupleDColumn("py");
+    man->CreateNtupleDColumn("pz");
+    man->CreateNtupleDColumn("weight");
+    man->FinishNtuple(0);
+
+    // 3) Hits de chaque shard, repondérés
+    auto* reader = G4RootAnalysisReader::Instance();
+    reader->SetVerboseLevel(0);
+    std::uint64_t eventOffset = 0, hits = 0;
+    double weight = 0.;
+    for (std::size_t k = 0; k < shards.size(); ++k) {
+        const auto& s = shards[k];
+        if (s.events == 0) continue;   // rang MPI sans événement : pas de fichier
+        const G4int id = reader->GetNtuple("momenta", s.output);
+        if (id < 0) {
+            std::cerr << "[merge] no 'momenta' ntuple in " << s.output << "\n";
+            return 1;
+        }
+        G4int eventID = 0;
+        G4double px = 0., py = 0., pz = 0., w = 0.;
+        reader->SetNtupleIColumn(id, "eventID", eventID);
+        reader->SetNtupleDColumn(id, "px", px);
+        reader->SetNtupleDColumn(id, "py", py);
+        reader->SetNtupleDColumn(id, "pz", pz);
+        reader->SetNtupleDColumn(id, "weight", w);
+
+        std::uint64_t n = 0;
+        while (reader->GetNtupleRow(id)) {
+            man->FillNtupleIColumn(0, 0, static_cast<G4int>(eventOffset + eventID));
+            man->FillNtupleDColumn(0, 1, px);
+            man->FillNtupleDColumn(0, 2, py);
+            man->FillNtupleDColumn(0, 3, pz);
+            man->FillNtupleDColumn(0, 4, w * factors[k]);
+            man->AddNtupleRow(0);
+            weight += w * factors[k];
+            ++n;
+        }
+        std::cout << "[merge] shard " << s.shard.index << "/" << s.shard.count << " : "
+                  << s.events << " événements, " << n << " hits, facteur "
+                  << factors[k] << " (" << s.output << ")\n";
+        eventOffset += s.events;
+        hits += n;
+    }
+    man->Write();
+    man->CloseFile();
+
+    std::cout << "[merge] " << shards.size() << " shards -> " << outPath << " : "
+              << eventOffset << " événements, " << hits << " hits, poids "
+              << weight << "\n";
+    return 0;
+}
@@ -0,0 +1,124 @@
+// tools/replay.cc
+//
+// Écrivain de substitution pour le couplage in situ (--stream) : rejoue
+// les itérations d'un dump WarpX déjà écrit dans un flux openPMD, une
+// itération publiée à la fois, comme le ferait WarpX pendant le run PIC.
+//
+//   replay_stream <openPMD_path> <flux> <species[,species...]>
+//                 [--delay s] [--first N] [--last N]
+//
+// Le moteur ADIOS2 est choisi par l'extension du flux (".sst" : SST,
+// transport en mémoire/réseau, sans fichier). Seuls les champs lus par
+// read_warpx_particles sont copiés : momentum/x,y,z et weighting.
+//
+// Essai local, deux terminaux :
+//   read_warpx_particles stream.sst electrons 0 1.0 10 --stream on
+//   replay_stream diags/openpmd_%T.bp stream.sst electrons --delay 2
+
+#include <openPMD/openPMD.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "read.hh"
+
+namespace
+{
+
+/// Composantes copiées : (record, composante)
+const std::pair<const char*, const char*> kComponents[] = {
+    {"momentum", "x"},
+    {"momentum", "y"},
+    {"momentum", "z"},
+    {"weighting", openPMD::RecordComponent::SCALAR},
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> positional;
+    double delay_s = 0.;
+    std::uint64_t first = 0, last = std::numeric_limits<std::uint64_t>::max();
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--delay" && i + 1 < argc) {
+            delay_s = std::atof(argv[++i]);
+        } else if (arg == "--first" && i + 1 < argc) {
+            first = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--last" && i + 1 < argc) {
+            last = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 3) {
+        std::fprintf(stderr,
+            "Usage: %s <openPMD_path> <flux> <species[,species...]> [--delay s] [--first N] [--last N]\n",
+            argv[0]);
+        return 1;
+    }
+    const auto species = wxg4::parse_species_list(positional[2]);
+
+    try {
+        openPMD::Series in(positional[0], openPMD::Access::READ_ONLY, wxg4::OPENPMD_READ_OPTIONS);
+        openPMD::Series out(positional[1], openPMD::Access::CREATE);
+        std::cout << "[replay] " << positional[0] << " -> " << positional[1]
+                  << " (backend " << out.backend() << ")\n";
+
+        std::size_t published = 0;
+        for (auto& [index, iteration] : in.iterations) {
+            if (index < first || index > last) continue;
+            iteration.open();
+
+            // 1) Lecture de toutes les composantes, un seul flush
+            struct Chunk { std::string species; const char* record; const char* component;
+                           std::shared_ptr<double> data; std::uint64_t n; };
+            std::vector<Chunk> chunks;
+            for (const auto& sp : species) {
+                if (iteration.particles.count(sp.name) == 0) {
+                    std::cerr << "[replay] itération " << index << " : espèce '"
+                              << sp.name << "' absente\n";
+                    continue;
+                }
+                auto& src = iteration.particles[sp.name];
+                for (const auto& [record, component] : kComponents) {
+                    auto& rc = src[record][component];
+                    chunks.push_back({sp.name, record, component,
+                                      rc.loadChunk<double>(), rc.getExtent()[0]});
+                }
+            }
+            in.flush();
+
+            // 2) Écriture puis publication du pas : le lecteur le voit à la fermeture
+            auto& step = out.writeIterations()[index];
+            for (auto& c : chunks) {
+                auto& dst = step.particles[c.species][c.record][c.component];
+                dst.resetDataset(openPMD::Dataset(openPMD::determineDatatype<double>(), {c.n}));
+                dst.storeChunk(c.data, {0}, {c.n});
+            }
+            step.close();
+            iteration.close();
+            ++published;
+            std::cout << "[replay] itération " << index << " publiée ("
+                      << chunks.size() / 4 << " espèce(s))\n";
+
+            if (delay_s > 0.) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(delay_s));
+            }
+        }
+        std::cout << "[replay] " << published << " itération(s) publiée(s), fin du flux\n";
+    } catch (const std::exception& e) {
+        std::cerr << "[replay] openPMD : " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}